@@ -21,6 +21,7 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -36,25 +37,50 @@ namespace Audio {
 #pragma mark --- Channel classes ---
 #pragma mark -
 
+/**
+ * Passes reads through to a channel's stream, adding the time spent
+ * decoding to a counter.
+ */
+class TimedAudioStream : public AudioStream {
+public:
+	TimedAudioStream(AudioStream &stream, uint64 &time) : _stream(stream), _time(time) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		const uint64 start = g_system->getMicros();
+		const int samples = _stream.readBuffer(buffer, numSamples);
+		_time += g_system->getMicros() - start;
+		return samples;
+	}
+
+	bool isStereo() const override { return _stream.isStereo(); }
+	int getRate() const override { return _stream.getRate(); }
+	bool endOfData() const override { return _stream.endOfData(); }
+	bool endOfStream() const override { return _stream.endOfStream(); }
+
+private:
+	AudioStream &_stream;
+	uint64 &_time;
+};
+
 
 /**
  * Channel used by the default Mixer implementation.
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, const SincFilter *filter);
 	~Channel();
 
 	/**
 	 * Mixes the channel's samples into the given buffer.
 	 *
-	 * @param data buffer where to mix the data
+	 * @param data 32-bit mix bus where to mix the data
 	 * @param len  number of sample *pairs*. So a value of
-	 *             10 means that the buffer contains twice 10 sample, each
-	 *             16 bits, for a total of 40 bytes.
+	 *             10 means that the buffer contains twice 10 samples.
+	 * @param timed whether to add the time spent to the channel's counters
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(int32 *data, uint len, bool timed);
 
 	/**
 	 * Queries whether the channel is still playing or not.
@@ -147,6 +173,22 @@ public:
 	 */
 	SoundHandle getHandle() const { return _handle; }
 
+	/**
+	 * Queries whether the stream ran out of data in the last mix pass
+	 * without having ended.
+	 */
+	bool hadUnderrun() const { return _underrun; }
+
+	/**
+	 * Fills in the channel's counters.
+	 */
+	void getStats(Mixer::ChannelStats &stats) const;
+
+	/**
+	 * Resets the channel's counters.
+	 */
+	void resetStats();
+
 private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
@@ -170,6 +212,13 @@ private:
 
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
+
+	bool _underrun;
+	uint32 _mixPasses;
+	uint64 _mixTime;
+	uint64 _flowTime;
+	uint64 _readTime;
+	uint32 _underruns;
 };
 
 #pragma mark -
@@ -177,17 +226,66 @@ private:
 #pragma mark -
 
 MixerImpl::MixerImpl(uint sampleRate, uint outBufSize)
-	: _mutex(), _sampleRate(sampleRate), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _outBufSize(outBufSize), _mixerReady(false), _timingEnabled(false), _handleSeed(0), _soundTypeSettings(),
+	  _mixBus(nullptr), _mixBusSize(0), _rateQuality(kRateQualityLow), _commandHead(0), _commandCount(0) {
 
 	assert(sampleRate > 0);
 
+	memset(&_commandStats, 0, sizeof(_commandStats));
+	memset(&_callbackStats, 0, sizeof(_callbackStats));
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		_channels[i] = nullptr;
+
+	for (int i = 0; i != NUM_SINC_FILTERS; i++)
+		_sincFilters[i] = nullptr;
+
+	if (ConfMan.hasKey("resampler_quality", Common::ConfigManager::kApplicationDomain)) {
+		const Common::String quality = ConfMan.get("resampler_quality", Common::ConfigManager::kApplicationDomain);
+		if (quality.equalsIgnoreCase("high"))
+			setRateConverterQuality(kRateQualityHigh);
+		else if (quality.equalsIgnoreCase("medium"))
+			setRateConverterQuality(kRateQualityMedium);
+		else if (!quality.equalsIgnoreCase("low"))
+			warning("Unknown resampler quality '%s'", quality.c_str());
+	}
 }
 
 MixerImpl::~MixerImpl() {
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+
+	free(_mixBus);
+
+	for (int i = 0; i != NUM_SINC_FILTERS; i++)
+		delete _sincFilters[i];
+}
+
+void MixerImpl::setRateConverterQuality(RateConverterQuality quality) {
+	Common::StackLock lock(_mutex);
+
+	_rateQuality = quality;
+
+	// Build the tables for the common game rates up front
+	getSincFilter(11025);
+	getSincFilter(22050);
+}
+
+const SincFilter *MixerImpl::getSincFilter(uint rate) {
+	if (_rateQuality == kRateQualityLow || !SincFilter::isSupported(rate, _sampleRate))
+		return nullptr;
+
+	for (int i = 0; i != NUM_SINC_FILTERS; i++) {
+		if (!_sincFilters[i]) {
+			_sincFilters[i] = new SincFilter(rate, _sampleRate, _rateQuality);
+			return _sincFilters[i];
+		}
+		if (_sincFilters[i]->getInRate() == rate && _sincFilters[i]->getQuality() == _rateQuality)
+			return _sincFilters[i];
+	}
+
+	// Out of slots, fall back to linear interpolation
+	return nullptr;
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -227,6 +325,183 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	Common::StackLock commandLock(_commandMutex);
+	_snapshots[index].handle = chanHandle._val;
+	_snapshots[index].volume = chan->getVolume();
+	_snapshots[index].balance = chan->getBalance();
+}
+
+void MixerImpl::deleteChannel(int index) {
+	delete _channels[index];
+	_channels[index] = nullptr;
+
+	// The snapshot is cleared only after the stream is gone, so a handle
+	// which reads as inactive never has a stream left in the mixer
+	Common::StackLock commandLock(_commandMutex);
+	_snapshots[index].handle = 0xFFFFFFFF;
+}
+
+bool MixerImpl::queueCommand(ChannelCommand::Type type, SoundHandle handle, int value) {
+	Common::StackLock commandLock(_commandMutex);
+
+	const int index = handle._val % NUM_CHANNELS;
+	if (_snapshots[index].handle != handle._val)
+		return true;
+
+	if (type == ChannelCommand::kSetVolume)
+		_snapshots[index].volume = value;
+	else
+		_snapshots[index].balance = value;
+
+	if (_commandCount == COMMAND_QUEUE_SIZE) {
+		_commandStats.overflows++;
+		return false;
+	}
+
+	ChannelCommand &command = _commands[(_commandHead + _commandCount) % COMMAND_QUEUE_SIZE];
+	command.type = type;
+	command.handle = handle._val;
+	command.value = value;
+	command.queuedTime = g_system->getMillis();
+	_commandCount++;
+	_commandStats.queued++;
+	return true;
+}
+
+void MixerImpl::applyCommands(bool mixPass) {
+	// Copy the commands out so the command mutex is not held while the
+	// channels are updated
+	ChannelCommand commands[COMMAND_QUEUE_SIZE];
+	uint count;
+	{
+		Common::StackLock commandLock(_commandMutex);
+		count = _commandCount;
+		for (uint i = 0; i < count; i++)
+			commands[i] = _commands[(_commandHead + i) % COMMAND_QUEUE_SIZE];
+		_commandHead = (_commandHead + count) % COMMAND_QUEUE_SIZE;
+		_commandCount = 0;
+		// Commands flushed early by a full queue do not count as a pass
+		if (mixPass) {
+			_commandStats.mixPasses++;
+			_commandStats.maxQueueDepth = MAX<uint32>(_commandStats.maxQueueDepth, count);
+		}
+	}
+
+	if (!count)
+		return;
+
+	const uint32 now = g_system->getMillis();
+	uint32 applied = 0, maxLatency = 0;
+	for (uint i = 0; i < count; i++) {
+		const ChannelCommand &command = commands[i];
+		const int index = command.handle % NUM_CHANNELS;
+		if (!_channels[index] || _channels[index]->getHandle()._val != command.handle)
+			continue;
+		if (command.type == ChannelCommand::kSetVolume)
+			_channels[index]->setVolume(command.value);
+		else
+			_channels[index]->setBalance(command.value);
+		maxLatency = MAX(maxLatency, now - command.queuedTime);
+		applied++;
+	}
+
+	Common::StackLock commandLock(_commandMutex);
+	_commandStats.applied += applied;
+	_commandStats.maxLatency = MAX(_commandStats.maxLatency, maxLatency);
+}
+
+void MixerImpl::updateCallbackStats(bool timed, uint64 waitStart, uint64 start, uint len) {
+	CallbackStats &stats = _callbackStats;
+	const uint32 bufferPeriod = (uint32)((uint64)len * 1000000 / _sampleRate);
+
+	stats.callbacks++;
+	if (!timed) {
+		stats.bufferPeriod = bufferPeriod;
+		stats.lastCallbackStart = 0;
+		return;
+	}
+
+	const uint32 lockWait = (uint32)(start - waitStart);
+	const uint32 duration = (uint32)(g_system->getMicros() - start);
+
+	// Measured against the period of the previous buffer, which is what
+	// the backend was playing in the meantime
+	if (stats.lastCallbackStart > 0 && stats.bufferPeriod > 0 &&
+		waitStart - stats.lastCallbackStart > stats.bufferPeriod * 3 / 2)
+		stats.lateCallbacks++;
+
+	stats.bufferPeriod = bufferPeriod;
+	if (duration > stats.bufferPeriod)
+		stats.slowCallbacks++;
+
+	stats.lastCallbackStart = waitStart;
+	stats.lastCallbackTime = duration;
+	stats.maxCallbackTime = MAX(stats.maxCallbackTime, duration);
+	stats.totalCallbackTime += duration;
+	stats.maxLockWait = MAX(stats.maxLockWait, lockWait);
+	stats.totalLockWait += lockWait;
+}
+
+void MixerImpl::getStats(Stats &stats) {
+	Common::StackLock lock(_mutex);
+
+	stats.callbacks = _callbackStats.callbacks;
+	stats.lateCallbacks = _callbackStats.lateCallbacks;
+	stats.slowCallbacks = _callbackStats.slowCallbacks;
+	stats.underruns = _callbackStats.underruns;
+	stats.bufferPeriod = _callbackStats.bufferPeriod;
+	stats.lastCallbackTime = _callbackStats.lastCallbackTime;
+	stats.maxCallbackTime = _callbackStats.maxCallbackTime;
+	stats.totalCallbackTime = _callbackStats.totalCallbackTime;
+	stats.maxLockWait = _callbackStats.maxLockWait;
+	stats.totalLockWait = _callbackStats.totalLockWait;
+
+	for (int i = 0; i != ARRAYSIZE(stats.activeStreams); i++)
+		stats.activeStreams[i] = 0;
+
+	stats.channels.clear();
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i] && !_channels[i]->isFinished()) {
+			stats.activeStreams[_channels[i]->getType()]++;
+
+			ChannelStats channelStats;
+			_channels[i]->getStats(channelStats);
+			stats.channels.push_back(channelStats);
+		}
+	}
+}
+
+void MixerImpl::resetStats() {
+	Common::StackLock lock(_mutex);
+
+	// Keep what the late callback check needs
+	const uint64 lastCallbackStart = _callbackStats.lastCallbackStart;
+	const uint32 bufferPeriod = _callbackStats.bufferPeriod;
+	memset(&_callbackStats, 0, sizeof(_callbackStats));
+	_callbackStats.lastCallbackStart = lastCallbackStart;
+	_callbackStats.bufferPeriod = bufferPeriod;
+
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i])
+			_channels[i]->resetStats();
+	}
+}
+
+void MixerImpl::setTimingEnabled(bool enable) {
+	if (enable == _timingEnabled)
+		return;
+
+	// A pass which read the flag before can still be running, it finishes
+	// before the counters are reset
+	Common::StackLock lock(_mutex);
+	_timingEnabled = enable;
+	resetStats();
+}
+
+MixerImpl::CommandStats MixerImpl::getCommandStats() {
+	Common::StackLock commandLock(_commandMutex);
+	return _commandStats;
 }
 
 void MixerImpl::playStream(
@@ -268,7 +543,7 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, getSincFilter(stream->getRate()));
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -277,7 +552,11 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
+	// Changes only take effect with the next pass, so the flag is read once
+	const bool timed = _timingEnabled;
+	const uint64 waitStart = timed ? g_system->getMicros() : 0;
 	Common::StackLock lock(_mutex);
+	const uint64 start = timed ? g_system->getMicros() : 0;
 
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
@@ -287,44 +566,57 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
-	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
+	applyCommands(true);
+
+	// Reallocate the mix bus, if necessary
+	if (2 * len > _mixBusSize) {
+		free(_mixBus);
+		_mixBus = (int32 *)malloc(2 * len * sizeof(int32));
+		_mixBusSize = 2 * len;
+
+		if (!_mixBus)
+			error("[MixerImpl::mixCallback] Cannot allocate memory for mix bus");
+	}
+
+	//  zero the bus
+	memset(_mixBus, 0, 2 * len * sizeof(int32));
 
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = nullptr;
+				deleteChannel(i);
 			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+				tmp = _channels[i]->mix(_mixBus, len, timed);
 
 				if (tmp > res)
 					res = tmp;
+				if (_channels[i]->hadUnderrun())
+					_callbackStats.underruns++;
 			}
 		}
 
+	saturateBus(buf, _mixBus, 2 * len);
+
+	updateCallbackStats(timed, waitStart, start, len);
+
 	return res;
 }
 
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = nullptr;
-		}
+		if (_channels[i] != nullptr && !_channels[i]->isPermanent())
+			deleteChannel(i);
 	}
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = nullptr;
-		}
+		if (_channels[i] != nullptr && _channels[i]->getId() == id)
+			deleteChannel(i);
 	}
 }
 
@@ -336,8 +628,7 @@ void MixerImpl::stopHandle(SoundHandle handle) {
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
-	delete _channels[index];
-	_channels[index] = nullptr;
+	deleteChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
@@ -356,8 +647,15 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
+	if (queueCommand(ChannelCommand::kSetVolume, handle, volume))
+		return;
+
 	Common::StackLock lock(_mutex);
 
+	// Apply the queued commands first, they are older than this one and
+	// would otherwise overwrite it in the next mixing pass
+	applyCommands(false);
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
@@ -366,16 +664,24 @@ void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
+	Common::StackLock commandLock(_commandMutex);
+
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (_snapshots[index].handle != handle._val)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return _snapshots[index].volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
+	if (queueCommand(ChannelCommand::kSetBalance, handle, balance))
+		return;
+
 	Common::StackLock lock(_mutex);
 
+	// See setChannelVolume()
+	applyCommands(false);
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
@@ -384,11 +690,13 @@ void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
+	Common::StackLock commandLock(_commandMutex);
+
 	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (_snapshots[index].handle != handle._val)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return _snapshots[index].balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -467,14 +775,14 @@ int MixerImpl::getSoundID(SoundHandle handle) {
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
+	// Answered from the snapshot, without waiting for a running mix pass
+	Common::StackLock commandLock(_commandMutex);
 	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return _snapshots[index].handle == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
@@ -515,16 +823,17 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, const SincFilter *filter)
 	: _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
 	  _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
 	  _pauseStartTime(0), _pauseTime(0), _converter(nullptr), _volL(0), _volR(0),
-	  _stream(stream, autofreeStream) {
+	  _stream(stream, autofreeStream), _underrun(false), _mixPasses(0), _mixTime(0), _flowTime(0),
+	  _readTime(0), _underruns(0) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, filter);
 }
 
 Channel::~Channel() {
@@ -634,9 +943,10 @@ void Channel::loop() {
 	}
 }
 
-int Channel::mix(int16 *data, uint len) {
+int Channel::mix(int32 *data, uint len, bool timed) {
 	assert(_stream);
 
+	const uint64 mixStart = timed ? g_system->getMicros() : 0;
 	int res = 0;
 	if (_stream->endOfData()) {
 		// TODO: call drain method
@@ -645,11 +955,50 @@ int Channel::mix(int16 *data, uint len) {
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
 		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
+
+		if (timed) {
+			TimedAudioStream input(*_stream, _readTime);
+			const uint64 flowStart = g_system->getMicros();
+			res = _converter->flow(input, data, len, _volL, _volR);
+			_flowTime += g_system->getMicros() - flowStart;
+		} else {
+			res = _converter->flow(*_stream, data, len, _volL, _volR);
+		}
+
 		_samplesDecoded += res;
 	}
 
+	// A stream which ends in this pass is not an underrun
+	_underrun = (uint)res < len && !_stream->endOfStream();
+	if (_underrun)
+		_underruns++;
+
+	_mixPasses++;
+	if (timed)
+		_mixTime += g_system->getMicros() - mixStart;
+
 	return res;
 }
 
+void Channel::getStats(Mixer::ChannelStats &stats) const {
+	stats.type = _type;
+	stats.id = _id;
+	stats.rate = _stream->getRate();
+	stats.stereo = _stream->isStereo();
+	stats.paused = isPaused();
+	stats.mixPasses = _mixPasses;
+	stats.mixTime = _mixTime;
+	stats.flowTime = _flowTime;
+	stats.readTime = _readTime;
+	stats.underruns = _underruns;
+}
+
+void Channel::resetStats() {
+	_mixPasses = 0;
+	_mixTime = 0;
+	_flowTime = 0;
+	_readTime = 0;
+	_underruns = 0;
+}
+
 } // End of namespace Audio
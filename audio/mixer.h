@@ -22,6 +22,7 @@
 #ifndef AUDIO_MIXER_H
 #define AUDIO_MIXER_H
 
+#include "common/array.h"
 #include "common/mutex.h"
 #include "common/types.h"
 #include "common/noncopyable.h"
@@ -311,6 +312,64 @@ public:
 	 * @return The number of samples processed at each audio callback.
 	 */
 	virtual uint getOutputBufSize() const = 0;
+
+	/**
+	 * Counters of one playing channel. Times are in microseconds and add up
+	 * from the start of the sound or the last resetStats(), they are only
+	 * measured while timing is enabled, see setTimingEnabled().
+	 */
+	struct ChannelStats {
+		SoundType type;
+		int id;
+		uint rate;
+		bool stereo;
+		bool paused;
+		uint32 mixPasses;  ///< Mix passes the channel took part in
+		uint64 mixTime;    ///< Time spent mixing the channel
+		uint64 flowTime;   ///< Part of mixTime spent in the rate converter
+		uint64 readTime;   ///< Part of flowTime spent decoding the stream
+		uint32 underruns;  ///< Passes where the stream had less data than needed
+	};
+
+	/**
+	 * Counters of the mixer callback. Times are in microseconds and add up
+	 * from the creation of the mixer or the last resetStats(). The times and
+	 * the late and slow callbacks need timing to be enabled.
+	 */
+	struct Stats {
+		uint32 callbacks;         ///< Number of mix callbacks
+		uint32 lateCallbacks;     ///< Callbacks started more than half a buffer period late
+		uint32 slowCallbacks;     ///< Callbacks which took longer than a buffer period
+		uint32 underruns;         ///< Channel underruns, including finished channels
+		uint32 bufferPeriod;      ///< Playback time of the last buffer
+		uint32 lastCallbackTime;  ///< Duration of the last callback
+		uint32 maxCallbackTime;   ///< Longest callback
+		uint64 totalCallbackTime; ///< Time spent in all callbacks
+		uint32 maxLockWait;       ///< Longest wait for the mixer lock in a callback
+		uint64 totalLockWait;     ///< Time all callbacks waited for the mixer lock
+		uint activeStreams[4];    ///< Playing channels by SoundType
+		Common::Array<ChannelStats> channels;
+	};
+
+	/**
+	 * Get the timing and usage counters, e.g. for a debugger console.
+	 *
+	 * @param stats  Receives the counters.
+	 */
+	virtual void getStats(Stats &stats) = 0;
+
+	/**
+	 * Reset the counters of the mixer and all playing channels.
+	 */
+	virtual void resetStats() = 0;
+
+	/**
+	 * Enable or disable the timing counters. Timing reads the system clock a
+	 * few times per channel and mix pass, so it is disabled by default.
+	 * Changing it resets the counters.
+	 */
+	virtual void setTimingEnabled(bool enable) = 0;
+	virtual bool isTimingEnabled() const = 0;
 };
 
 /** @} */
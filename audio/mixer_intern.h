@@ -25,6 +25,7 @@
 #include "common/scummsys.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -58,7 +59,9 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 32
+		NUM_CHANNELS = 32,
+		COMMAND_QUEUE_SIZE = 64,
+		NUM_SINC_FILTERS = 8
 	};
 
 	Common::Mutex _mutex;
@@ -66,6 +69,7 @@ private:
 	const uint _sampleRate;
 	const uint _outBufSize;
 	bool _mixerReady;
+	bool _timingEnabled;	///< Read once per mix pass, see setTimingEnabled()
 	uint32 _handleSeed;
 
 	struct SoundTypeSettings {
@@ -78,6 +82,74 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * All channels are summed into this 32-bit bus, which is clamped to
+	 * 16 bits once per mix pass.
+	 */
+	int32 *_mixBus;
+	uint _mixBusSize;
+
+	RateConverterQuality _rateQuality;
+
+	/**
+	 * Windowed-sinc tables are expensive to build, so they are kept for the
+	 * lifetime of the mixer and shared by all channels with the same rate.
+	 */
+	SincFilter *_sincFilters[NUM_SINC_FILTERS];
+
+	/** Callback counters, see Mixer::Stats */
+	struct CallbackStats {
+		uint32 callbacks;
+		uint32 lateCallbacks;
+		uint32 slowCallbacks;
+		uint32 underruns;
+		uint32 bufferPeriod;
+		uint32 lastCallbackTime;
+		uint32 maxCallbackTime;
+		uint64 totalCallbackTime;
+		uint32 maxLockWait;
+		uint64 totalLockWait;
+		uint64 lastCallbackStart;
+	};
+
+	CallbackStats _callbackStats;
+
+	/**
+	 * Volume and balance changes are queued and applied at the start of the
+	 * next mix pass, so the caller does not have to wait for a running mix
+	 * pass to finish. The queue has its own mutex which is only ever held
+	 * for a few instructions.
+	 */
+	struct ChannelCommand {
+		enum Type {
+			kSetVolume,
+			kSetBalance
+		};
+
+		Type type;
+		uint32 handle;
+		int value;
+		uint32 queuedTime;
+	};
+
+	/**
+	 * The state of a channel slot as last published by the mixer, readable
+	 * under the command mutex.
+	 */
+	struct ChannelSnapshot {
+		ChannelSnapshot() : handle(0xFFFFFFFF), volume(0), balance(0) {}
+
+		uint32 handle;
+		byte volume;
+		int8 balance;
+	};
+
+	Common::Mutex _commandMutex;
+	ChannelCommand _commands[COMMAND_QUEUE_SIZE];
+	uint _commandHead;
+	uint _commandCount;
+	ChannelSnapshot _snapshots[NUM_CHANNELS];
+
 
 public:
 
@@ -131,8 +203,45 @@ public:
 	virtual uint getOutputRate() const;
 	virtual uint getOutputBufSize() const;
 
+	virtual void getStats(Stats &stats);
+	virtual void resetStats();
+	virtual void setTimingEnabled(bool enable);
+	virtual bool isTimingEnabled() const { return _timingEnabled; }
+
+	/**
+	 * Counters for the channel command queue.
+	 */
+	struct CommandStats {
+		uint32 queued;          ///< Commands queued by setChannelVolume/setChannelBalance
+		uint32 applied;         ///< Commands applied to a still playing channel
+		uint32 overflows;       ///< Commands applied directly because the queue was full
+		uint32 maxQueueDepth;   ///< Most commands waiting at the start of a mix pass
+		uint32 maxLatency;      ///< Longest time a command waited for a mix pass, in ms
+		uint32 mixPasses;       ///< Number of mix passes
+	};
+
+	/** Returns a copy of the current command queue counters. */
+	CommandStats getCommandStats();
+
+	/**
+	 * Set the resampling quality used for channels started from now on. The
+	 * initial value comes from the "resampler_quality" config key.
+	 */
+	void setRateConverterQuality(RateConverterQuality quality);
+	RateConverterQuality getRateConverterQuality() const { return _rateQuality; }
+
 protected:
+	/** Returns the filter for resampling from 'rate', or nullptr. Call with _mutex held. */
+	const SincFilter *getSincFilter(uint rate);
+
 	void insertChannel(SoundHandle *handle, Channel *chan);
+	void deleteChannel(int index);
+	void updateCallbackStats(bool timed, uint64 waitStart, uint64 start, uint len);
+	bool queueCommand(ChannelCommand::Type type, SoundHandle handle, int value);
+	/** Apply the queued channel commands. Call with _mutex held. */
+	void applyCommands(bool mixPass);
+
+	CommandStats _commandStats;
 
 public:
 	/**
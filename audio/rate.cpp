@@ -30,10 +30,20 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/algorithm.h"
 #include "common/frac.h"
+#include "common/math.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define AUDIO_RATE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AUDIO_RATE_NEON
+#include <arm_neon.h>
+#endif
+
 namespace Audio {
 
 
@@ -56,6 +66,175 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+static inline void mixSample(st_sample_t &a, int b) {
+	clampedAdd(a, b);
+}
+
+static inline void mixSample(st_bus_t &a, int b) {
+	a += b;
+}
+
+/**
+ * Apply the channel volumes to 'frames' sample frames from 'src' and mix
+ * them into the 16-bit output buffer. Mono input goes to both channels.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixFrames(st_sample_t *obuf, const st_sample_t *src, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; frames > 0; frames--) {
+		st_sample_t out0, out1;
+		out0 = *src++;
+		out1 = (stereo ? *src++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
+#if defined(AUDIO_RATE_SSE2) || defined(AUDIO_RATE_NEON)
+
+// The vector kernels divide by shifting, rounding towards zero like the
+// scalar division does.
+STATIC_ASSERT(Audio::Mixer::kMaxMixerVolume == 256, mixer_volume_is_not_a_power_of_two);
+
+#ifdef AUDIO_RATE_SSE2
+
+static inline __m128i scaleVolume(__m128i p) {
+	const __m128i bias = _mm_and_si128(_mm_srai_epi32(p, 31), _mm_set1_epi32(255));
+	return _mm_srai_epi32(_mm_add_epi32(p, bias), 8);
+}
+
+/**
+ * Mix blocks of four frames into the bus. Reverse stereo input is swapped
+ * first, so the volumes are always in output order.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixFramesSIMD(st_bus_t *obuf, const st_sample_t *src, st_size_t blocks, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i vol = _mm_unpacklo_epi16(_mm_set1_epi16(reverseStereo ? vol_r : vol_l), _mm_set1_epi16(reverseStereo ? vol_l : vol_r));
+
+	for (; blocks > 0; blocks--) {
+		__m128i in;
+		if (stereo) {
+			in = _mm_loadu_si128((const __m128i *)src);
+			if (reverseStereo)
+				in = _mm_shufflehi_epi16(_mm_shufflelo_epi16(in, 0xB1), 0xB1);
+			src += 8;
+		} else {
+			in = _mm_loadl_epi64((const __m128i *)src);
+			in = _mm_unpacklo_epi16(in, in);
+			src += 4;
+		}
+
+		const __m128i lo = _mm_mullo_epi16(in, vol);
+		const __m128i hi = _mm_mulhi_epi16(in, vol);
+		__m128i *out = (__m128i *)obuf;
+		_mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), scaleVolume(_mm_unpacklo_epi16(lo, hi))));
+		_mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1), scaleVolume(_mm_unpackhi_epi16(lo, hi))));
+		obuf += 8;
+	}
+}
+
+#else
+
+static inline int32x4_t scaleVolume(int32x4_t p) {
+	const uint32x4_t bias = vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p, 31)), 24);
+	return vshrq_n_s32(vaddq_s32(p, vreinterpretq_s32_u32(bias)), 8);
+}
+
+/**
+ * Mix blocks of four frames into the bus. Reverse stereo input is swapped
+ * first, so the volumes are always in output order.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixFramesSIMD(st_bus_t *obuf, const st_sample_t *src, st_size_t blocks, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16x4_t vol = vzip_s16(vdup_n_s16(reverseStereo ? vol_r : vol_l), vdup_n_s16(reverseStereo ? vol_l : vol_r)).val[0];
+
+	for (; blocks > 0; blocks--) {
+		int16x8_t in;
+		if (stereo) {
+			in = vld1q_s16(src);
+			if (reverseStereo)
+				in = vrev32q_s16(in);
+			src += 8;
+		} else {
+			const int16x4_t mono = vld1_s16(src);
+			const int16x4x2_t pairs = vzip_s16(mono, mono);
+			in = vcombine_s16(pairs.val[0], pairs.val[1]);
+			src += 4;
+		}
+
+		vst1q_s32(obuf, vaddq_s32(vld1q_s32(obuf), scaleVolume(vmull_s16(vget_low_s16(in), vol))));
+		vst1q_s32(obuf + 4, vaddq_s32(vld1q_s32(obuf + 4), scaleVolume(vmull_s16(vget_high_s16(in), vol))));
+		obuf += 8;
+	}
+}
+
+#endif
+
+#endif
+
+/**
+ * Apply the channel volumes to 'frames' sample frames from 'src' and add
+ * them to the mix bus. Mono input goes to both channels.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixFrames(st_bus_t *obuf, const st_sample_t *src, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+#if defined(AUDIO_RATE_SSE2) || defined(AUDIO_RATE_NEON)
+	// The multiply is signed 16-bit
+	if (vol_l <= 0x7fff && vol_r <= 0x7fff) {
+		const st_size_t blocks = frames / 4;
+		mixFramesSIMD<stereo, reverseStereo>(obuf, src, blocks, vol_l, vol_r);
+		obuf += blocks * 8;
+		src += blocks * (stereo ? 8 : 4);
+		frames -= blocks * 4;
+	}
+#endif
+
+	for (; frames > 0; frames--) {
+		st_sample_t out0, out1;
+		out0 = *src++;
+		out1 = (stereo ? *src++ : out0);
+
+		obuf[reverseStereo    ] += (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume;
+		obuf[reverseStereo ^ 1] += (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume;
+
+		obuf += 2;
+	}
+}
+
+void saturateBus(st_sample_t *obuf, const st_bus_t *bus, st_size_t count) {
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#if defined(AUDIO_RATE_SSE2)
+	for (; count >= 8; count -= 8) {
+		const __m128i lo = _mm_loadu_si128((const __m128i *)bus);
+		const __m128i hi = _mm_loadu_si128((const __m128i *)(bus + 4));
+		_mm_storeu_si128((__m128i *)obuf, _mm_packs_epi32(lo, hi));
+		bus += 8;
+		obuf += 8;
+	}
+#elif defined(AUDIO_RATE_NEON)
+	for (; count >= 8; count -= 8) {
+		vst1q_s16(obuf, vcombine_s16(vqmovn_s32(vld1q_s32(bus)), vqmovn_s32(vld1q_s32(bus + 4))));
+		bus += 8;
+		obuf += 8;
+	}
+#endif
+#endif
+
+	for (; count > 0; count--) {
+		const int val = CLIP<int>(*bus++, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		*obuf++ = ((int16)val) ^ 0x8000;
+#else
+		*obuf++ = val;
+#endif
+	}
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -76,9 +255,17 @@ protected:
 	/** fractional position increment in the output stream */
 	long opos_inc;
 
+	template<typename T>
+	int flowTo(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override;
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
+		return flowTo(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, st_bus_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
+		return flowTo(input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) override {
 		return ST_SUCCESS;
 	}
@@ -111,8 +298,9 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
+template<typename T>
+int SimpleRateConverter<stereo, reverseStereo>::flowTo(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
@@ -143,10 +331,10 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 		opos += opos_inc;
 
 		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		mixSample(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
 		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		mixSample(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
 
 		obuf += 2;
 	}
@@ -182,9 +370,20 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolated samples, mixed into the output in one go */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	template<typename T>
+	int flowTo(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override;
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
+		return flowTo(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, st_bus_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
+		return flowTo(input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) override {
 		return ST_SUCCESS;
 	}
@@ -220,56 +419,55 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
-
-	ostart = obuf;
-	oend = obuf + osamp * 2;
-
-	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+template<typename T>
+int LinearRateConverter<stereo, reverseStereo>::flowTo(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const st_size_t maxFrames = ARRAYSIZE(outBuf) / (stereo ? 2 : 1);
+	st_size_t done = 0;
+	bool endOfInput = false;
+
+	while (done < osamp && !endOfInput) {
+		const st_size_t count = MIN<st_size_t>(osamp - done, maxFrames);
+		st_sample_t *out = outBuf;
+		st_size_t frames = 0;
+
+		while (frames < count) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
-			}
-			opos -= FRAC_ONE_LOW;
-		}
+			if (endOfInput)
+				break;
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
 			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
+			*out++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+			if (stereo)
+				*out++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+			frames++;
 
 			// Increment output position
 			opos += opos_inc;
 		}
+
+		mixFrames<stereo, reverseStereo>(obuf + done * 2, outBuf, frames, vol_l, vol_r);
+		done += frames;
 	}
-	return (obuf - ostart) / 2;
+	return done;
 }
 
 
@@ -289,14 +487,10 @@ public:
 		free(_buffer);
 	}
 
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
+	template<typename T>
+	int flowTo(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
-		st_size_t len;
-
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -311,31 +505,245 @@ public:
 			error("[CopyRateConverter::flow] Cannot allocate memory for temp buffer");
 
 		// Read up to 'osamp' samples into our temporary buffer
-		len = input.readBuffer(_buffer, osamp);
+		const int len = input.readBuffer(_buffer, osamp);
+		if (len <= 0)
+			return 0;
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
+		const st_size_t frames = len / (stereo ? 2 : 1);
+		mixFrames<stereo, reverseStereo>(obuf, _buffer, frames, vol_l, vol_r);
+		return frames;
+	}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
+		return flowTo(input, obuf, osamp, vol_l, vol_r);
+	}
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+	int flow(AudioStream &input, st_bus_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
+		return flowTo(input, obuf, osamp, vol_l, vol_r);
+	}
 
-			obuf += 2;
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) override {
+		return ST_SUCCESS;
+	}
+};
+
+
+#pragma mark -
+
+
+/** Zeroth order modified Bessel function of the first kind, for the Kaiser window. */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		const double t = x / (2.0 * k);
+		term *= t * t;
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+bool SincFilter::isSupported(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate == 0 || inrate >= outrate)
+		return false;
+	return outrate / Common::gcd(inrate, outrate) <= kMaxPhases;
+}
+
+SincFilter::SincFilter(st_rate_t inrate, st_rate_t outrate, RateConverterQuality quality) :
+		_inRate(inrate), _outRate(outrate), _quality(quality) {
+	assert(isSupported(inrate, outrate));
+
+	const st_rate_t g = Common::gcd(inrate, outrate);
+	_phases = outrate / g;
+	_step = inrate / g;
+
+	// The cutoff is relative to the input Nyquist frequency. The shorter
+	// filter needs a lower cutoff for its wider transition band.
+	double cutoff, beta;
+	if (quality == kRateQualityHigh) {
+		_taps = 32;
+		cutoff = 0.90;
+		beta = 8.0;
+	} else {
+		_taps = 16;
+		cutoff = 0.85;
+		beta = 6.0;
+	}
+
+	_coeffs = new int16[_phases * _taps];
+
+	const double halfWidth = _taps / 2;
+	const double windowScale = 1.0 / besselI0(beta);
+	double taps[kMaxTaps];
+
+	for (int phase = 0; phase < _phases; phase++) {
+		// Tap k sits at input sample (newest - taps + 1 + k), the output
+		// is 'phase / phases' after input sample (newest - taps / 2).
+		double sum = 0.0;
+		for (int k = 0; k < _taps; k++) {
+			const double d = k - (halfWidth - 1) - (double)phase / _phases;
+			const double x = d / halfWidth;
+			const double window = (x > -1.0 && x < 1.0) ? besselI0(beta * sqrt(1.0 - x * x)) * windowScale : 0.0;
+			const double arg = M_PI * cutoff * d;
+			const double sinc = (d == 0.0) ? 1.0 : sin(arg) / arg;
+			taps[k] = cutoff * sinc * window;
+			sum += taps[k];
 		}
-		return (obuf - ostart) / 2;
+
+		// Normalize each phase to unity gain, so DC passes unchanged
+		int16 *coeffs = _coeffs + phase * _taps;
+		for (int k = 0; k < _taps; k++)
+			coeffs[k] = (int16)floor(taps[k] / sum * 16384.0 + 0.5);
+	}
+}
+
+SincFilter::~SincFilter() {
+	delete[] _coeffs;
+}
+
+/**
+ * Apply a phase of the filter to the last 'taps' samples, 'taps' being a
+ * multiple of eight.
+ */
+static inline st_sample_t sincSample(const st_sample_t *src, const int16 *coeffs, int taps) {
+	int sum;
+#if defined(AUDIO_RATE_SSE2)
+	__m128i acc = _mm_setzero_si128();
+	for (int i = 0; i < taps; i += 8)
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(src + i)), _mm_loadu_si128((const __m128i *)(coeffs + i))));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+	sum = _mm_cvtsi128_si32(acc);
+#elif defined(AUDIO_RATE_NEON)
+	int32x4_t acc = vdupq_n_s32(0);
+	for (int i = 0; i < taps; i += 8) {
+		const int16x8_t a = vld1q_s16(src + i);
+		const int16x8_t b = vld1q_s16(coeffs + i);
+		acc = vmlal_s16(acc, vget_low_s16(a), vget_low_s16(b));
+		acc = vmlal_s16(acc, vget_high_s16(a), vget_high_s16(b));
 	}
+	const int32x2_t pair = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+	sum = vget_lane_s32(vpadd_s32(pair, pair), 0);
+#else
+	sum = 0;
+	for (int i = 0; i < taps; i++)
+		sum += src[i] * coeffs[i];
+#endif
+	return (st_sample_t)CLIP<int>((sum + (1 << 13)) >> 14, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+}
 
+/**
+ * Audio rate converter based on a polyphase windowed-sinc filter. Much
+ * better at suppressing the images of upsampling than linear interpolation,
+ * at several times the CPU cost.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	enum {
+		HISTORY_SIZE = SincFilter::kMaxTaps + INTERMEDIATE_BUFFER_SIZE
+	};
+
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+	const st_sample_t *inPtr;
+	int inLen;
+
+	const SincFilter &_filter;
+
+	/** current phase, an input sample is consumed whenever it reaches the phase count */
+	int _phase;
+
+	/** input samples per channel, the newest one is just before _historyPos */
+	st_sample_t _history[2][HISTORY_SIZE];
+	int _historyPos;
+
+	/** filtered samples, mixed into the output in one go */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	template<typename T>
+	int flowTo(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
+public:
+	SincRateConverter(const SincFilter &filter) : inPtr(nullptr), inLen(0), _filter(filter), _phase(0) {
+		memset(_history, 0, sizeof(_history));
+		_historyPos = _filter.getTaps();
+	}
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
+		return flowTo(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flow(AudioStream &input, st_bus_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) override {
+		return flowTo(input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) override {
 		return ST_SUCCESS;
 	}
 };
 
+template<bool stereo, bool reverseStereo>
+template<typename T>
+int SincRateConverter<stereo, reverseStereo>::flowTo(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const st_size_t maxFrames = ARRAYSIZE(outBuf) / (stereo ? 2 : 1);
+	const int taps = _filter.getTaps();
+	const int phases = _filter.getPhases();
+	const int step = _filter.getStep();
+	st_size_t done = 0;
+	bool endOfInput = false;
+
+	while (done < osamp && !endOfInput) {
+		const st_size_t count = MIN<st_size_t>(osamp - done, maxFrames);
+		st_sample_t *out = outBuf;
+		st_size_t frames = 0;
+
+		while (frames < count) {
+			// Consume input samples until the phase is back in range
+			while (_phase >= phases) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						inLen = 0;
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+
+				// Keep the last 'taps' samples when the history is full
+				if (_historyPos == HISTORY_SIZE) {
+					memmove(_history[0], _history[0] + HISTORY_SIZE - taps, taps * sizeof(st_sample_t));
+					if (stereo)
+						memmove(_history[1], _history[1] + HISTORY_SIZE - taps, taps * sizeof(st_sample_t));
+					_historyPos = taps;
+				}
+				_history[0][_historyPos] = *inPtr++;
+				if (stereo)
+					_history[1][_historyPos] = *inPtr++;
+				_historyPos++;
+
+				_phase -= phases;
+			}
+			if (endOfInput)
+				break;
+
+			const int16 *coeffs = _filter.getCoefficients(_phase);
+			*out++ = sincSample(_history[0] + _historyPos - taps, coeffs, taps);
+			if (stereo)
+				*out++ = sincSample(_history[1] + _historyPos - taps, coeffs, taps);
+			frames++;
+
+			_phase += step;
+		}
+
+		mixFrames<stereo, reverseStereo>(obuf + done * 2, outBuf, frames, vol_l, vol_r);
+		done += frames;
+	}
+	return done;
+}
+
 
 #pragma mark -
 
@@ -365,4 +773,17 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stere
 		return makeRateConverter<false, false>(inrate, outrate);
 }
 
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, const SincFilter *filter) {
+	if (!filter || filter->getInRate() != inrate || filter->getOutRate() != outrate)
+		return makeRateConverter(inrate, outrate, stereo, reverseStereo);
+
+	if (stereo) {
+		if (reverseStereo)
+			return new SincRateConverter<true, true>(*filter);
+		else
+			return new SincRateConverter<true, false>(*filter);
+	} else
+		return new SincRateConverter<false, false>(*filter);
+}
+
 } // End of namespace Audio
@@ -36,6 +36,7 @@ namespace Audio {
 class AudioStream;
 
 typedef int16 st_sample_t;
+typedef int32 st_bus_t;
 typedef uint16 st_volume_t;
 typedef uint32 st_size_t;
 typedef uint32 st_rate_t;
@@ -51,6 +52,15 @@ enum {
 	ST_SUCCESS = 0
 };
 
+/**
+ * Trade-off between resampling quality and CPU time.
+ */
+enum RateConverterQuality {
+	kRateQualityLow,    ///< Linear interpolation
+	kRateQualityMedium, ///< 16 tap windowed sinc
+	kRateQualityHigh    ///< 32 tap windowed sinc
+};
+
 static inline void clampedAdd(int16& a, int b) {
 	int val;
 #ifdef OUTPUT_UNSIGNED_AUDIO
@@ -81,10 +91,69 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Same as above, but accumulates into a 32-bit mix bus without clamping.
+	 * The bus is saturated to 16 bits once all streams are mixed, see
+	 * saturateBus().
+	 *
+	 * @return Number of sample pairs written into the buffer.
+	 */
+	virtual int flow(AudioStream &input, st_bus_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
+/**
+ * Polyphase windowed-sinc coefficients for upsampling by a fixed ratio.
+ * Building the table is much more expensive than converting, so one filter
+ * is meant to be shared by all converters with the same rates.
+ */
+class SincFilter {
+public:
+	enum {
+		kMaxPhases = 1024,
+		kMaxTaps = 32
+	};
+
+	SincFilter(st_rate_t inrate, st_rate_t outrate, RateConverterQuality quality);
+	~SincFilter();
+
+	/** Whether the ratio is an upsampling one with few enough phases. */
+	static bool isSupported(st_rate_t inrate, st_rate_t outrate);
+
+	st_rate_t getInRate() const { return _inRate; }
+	st_rate_t getOutRate() const { return _outRate; }
+	RateConverterQuality getQuality() const { return _quality; }
+
+	int getTaps() const { return _taps; }
+	int getPhases() const { return _phases; }
+	int getStep() const { return _step; }
+
+	/** Returns the Q14 coefficients for the given phase, oldest sample first. */
+	const int16 *getCoefficients(int phase) const { return _coeffs + phase * _taps; }
+
+private:
+	st_rate_t _inRate, _outRate;
+	RateConverterQuality _quality;
+	int _taps;
+	int _phases;
+	int _step;
+	int16 *_coeffs;
+};
+
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+
+/**
+ * Create a rate converter which uses the given filter if it matches the rates,
+ * or one of the interpolating converters otherwise. The filter must outlive
+ * the converter.
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, const SincFilter *filter);
+
+/**
+ * Clamp 'count' mix bus samples to 16 bits and store them in 'obuf'.
+ */
+void saturateBus(st_sample_t *obuf, const st_bus_t *bus, st_size_t count);
 /** @} */
 } // End of namespace Audio
 
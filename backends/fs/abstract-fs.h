@@ -172,6 +172,16 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Returns the size and the time of the last modification of the file
+	 * referred by this node, without opening it. The time is only meant
+	 * for noticing changes, it need not be in any particular unit.
+	 *
+	 * The default implementation is for backends which cannot do this.
+	 *
+	 * @return true if the node is a file and both values are known
+	 */
+	virtual bool getFileStat(int64 &size, int64 &modificationTime) const { return false; }
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
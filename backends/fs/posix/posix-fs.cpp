@@ -78,6 +78,24 @@ bool POSIXFilesystemNode::isWritable() const {
 	return retVal;
 }
 
+bool POSIXFilesystemNode::getFileStat(int64 &size, int64 &modificationTime) const {
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+
+	size = st.st_size;
+	// In nanoseconds where available, so that changes within the same second
+	// are noticed on file systems which record them
+#if defined(__APPLE__)
+	modificationTime = (int64)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+	modificationTime = (int64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+	modificationTime = st.st_mtime;
+#endif
+	return true;
+}
+
 void POSIXFilesystemNode::setFlags() {
 	struct stat st;
 
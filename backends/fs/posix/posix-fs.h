@@ -60,6 +60,7 @@ public:
 	bool isDirectory() const override { return _isDirectory; }
 	bool isReadable() const override;
 	bool isWritable() const override;
+	bool getFileStat(int64 &size, int64 &modificationTime) const override;
 
 	AbstractFSNode *getChild(const Common::String &n) const override;
 	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override;
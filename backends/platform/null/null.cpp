@@ -86,6 +86,9 @@ public:
 
 	virtual Common::MutexInternal *createMutex();
 	virtual uint32 getMillis(bool skipRecord = false);
+#ifdef POSIX
+	virtual uint64 getMicros();
+#endif
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &td, bool skipRecord = false) const;
 
@@ -203,6 +206,16 @@ uint32 OSystem_NULL::getMillis(bool skipRecord) {
 #endif
 }
 
+#ifdef POSIX
+uint64 OSystem_NULL::getMicros() {
+	timeval curTime;
+
+	gettimeofday(&curTime, 0);
+
+	return (uint64)(curTime.tv_sec - _startTime.tv_sec) * 1000000 + (curTime.tv_usec - _startTime.tv_usec);
+}
+#endif
+
 void OSystem_NULL::delayMillis(uint msecs) {
 #ifdef POSIX
 	usleep(msecs * 1000);
@@ -30,6 +30,7 @@
 // FIXME: Avoid using printf
 #define FORBIDDEN_SYMBOL_EXCEPTION_printf
 
+#include "engines/advancedDetector.h"
 #include "engines/engine.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
@@ -103,7 +104,11 @@ static bool launcherDialog() {
 	GUI::LauncherChooser dlg;
 	dlg.selectLauncher();
 #endif
-	return (dlg.runModal() != -1);
+	bool result = (dlg.runModal() != -1);
+
+	// Keep the checksums of games added in the launcher
+	MD5Man.savePersistentCache();
+	return result;
 }
 
 static const Plugin *detectPlugin() {
@@ -699,6 +704,10 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 			launcherDialog();
 		}
 	}
+
+	// The detection when starting a game may have added checksums
+	MD5Man.savePersistentCache();
+
 #ifdef USE_CLOUD
 #ifdef USE_SDL_NET
 	Networking::LocalWebserver::destroy();
@@ -98,6 +98,7 @@ void SearchSet::add(const String &name, Archive *archive, int priority, bool aut
 	if (find(name) == _list.end()) {
 		Node node(priority, name, archive, autoFree);
 		insert(node);
+		invalidateIndex();
 	} else {
 		if (autoFree)
 			delete archive;
@@ -173,6 +174,7 @@ void SearchSet::remove(const String &name) {
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		invalidateIndex();
 	}
 }
 
@@ -187,6 +189,7 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	invalidateIndex();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -203,15 +206,65 @@ void SearchSet::setPriority(const String &name, int priority) {
 	_list.erase(it);
 	node._priority = priority;
 	insert(node);
+	invalidateIndex();
+}
+
+void SearchSet::invalidateIndex() {
+	_index.clear();
+	_unindexed.clear();
+	_indexed = false;
+}
+
+void SearchSet::ensureIndexed() const {
+	if (_indexed)
+		return;
+
+	Array<String> paths;
+	uint order = 0;
+	for (ArchiveNodeList::const_iterator it = _list.begin(); it != _list.end(); ++it, ++order) {
+		paths.clear();
+		if (!it->_arc->listMemberPaths(paths)) {
+			_unindexed.push_back(IndexEntry(order, it->_arc));
+			continue;
+		}
+
+		// Archives earlier in the list take precedence
+		for (uint i = 0; i < paths.size(); ++i) {
+			if (!_index.contains(paths[i]))
+				_index[paths[i]] = IndexEntry(order, it->_arc);
+		}
+	}
+
+	_indexed = true;
+}
+
+const SearchSet::IndexEntry *SearchSet::lookupIndex(const Path &path) const {
+	ensureIndexed();
+
+	NameIndex::const_iterator it = _index.find(path.rawString());
+	return it != _index.end() ? &it->_value : nullptr;
 }
 
 bool SearchSet::hasFile(const Path &path) const {
 	if (path.empty())
 		return false;
 
+	const IndexEntry *entry = lookupIndex(path);
+	if (!entry) {
+		for (uint i = 0; i < _unindexed.size(); ++i) {
+			if (_unindexed[i]._arc->hasFile(path))
+				return true;
+		}
+		return false;
+	}
+
+	if (entry->_arc->hasFile(path))
+		return true;
+
+	// The file may have gone away since the index was built
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(path))
+		if (it->_arc != entry->_arc && it->_arc->hasFile(path))
 			return true;
 	}
 
@@ -242,12 +295,18 @@ const ArchiveMemberPtr SearchSet::getMember(const Path &path) const {
 	if (path.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(path))
-			return it->_arc->getMember(path);
+	// Archives without an index entry still need to be asked if they come first
+	const IndexEntry *entry = lookupIndex(path);
+	for (uint i = 0; i < _unindexed.size(); ++i) {
+		if (entry && _unindexed[i]._order > entry->_order)
+			break;
+		if (_unindexed[i]._arc->hasFile(path))
+			return _unindexed[i]._arc->getMember(path);
 	}
 
+	if (entry)
+		return entry->_arc->getMember(path);
+
 	return ArchiveMemberPtr();
 }
 
@@ -255,9 +314,29 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const Path &path) const
 	if (path.empty())
 		return nullptr;
 
+	const IndexEntry *entry = lookupIndex(path);
+	for (uint i = 0; i < _unindexed.size(); ++i) {
+		if (entry && _unindexed[i]._order > entry->_order)
+			break;
+		SeekableReadStream *stream = _unindexed[i]._arc->createReadStreamForMember(path);
+		if (stream)
+			return stream;
+	}
+
+	if (!entry)
+		return nullptr;
+
+	SeekableReadStream *stream = entry->_arc->createReadStreamForMember(path);
+	if (stream)
+		return stream;
+
+	// The file may have gone away since the index was built, so fall back
+	// to asking every archive in turn
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
-		SeekableReadStream *stream = it->_arc->createReadStreamForMember(path);
+		if (it->_arc == entry->_arc)
+			continue;
+		stream = it->_arc->createReadStreamForMember(path);
 		if (stream)
 			return stream;
 	}
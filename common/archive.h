@@ -22,6 +22,9 @@
 #ifndef COMMON_ARCHIVE_H
 #define COMMON_ARCHIVE_H
 
+#include "common/array.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
 #include "common/str.h"
 #include "common/list.h"
 #include "common/path.h"
@@ -125,6 +128,17 @@ public:
 	 */
 	virtual int listMembers(ArchiveMemberList &list) const = 0;
 
+	/**
+	 * Add the paths of all members to the list, in the raw form accepted by
+	 * hasFile(). This lets a SearchSet answer lookups from a single index.
+	 *
+	 * Archives which resolve names on demand and cannot list all of them up
+	 * front return false, and are then always asked directly.
+	 *
+	 * @return True if the list is complete.
+	 */
+	virtual bool listMemberPaths(Array<String> &paths) const { return false; }
+
 	/**
 	 * Return an ArchiveMember representation of the given file.
 	 */
@@ -168,8 +182,25 @@ class SearchSet : public Archive {
 
 	bool _ignoreClashes;
 
+	// Position of an archive in the priority list, lower positions are searched first
+	struct IndexEntry {
+		uint _order;
+		Archive *_arc;
+		IndexEntry() : _order(0), _arc(nullptr) { }
+		IndexEntry(uint order, Archive *arc) : _order(order), _arc(arc) { }
+	};
+	// Maps member paths to the first archive having them, case insensitive
+	typedef HashMap<String, IndexEntry, IgnoreCase_Hash, IgnoreCase_EqualTo> NameIndex;
+	mutable NameIndex _index;
+	// Archives which cannot list their members, in priority order
+	mutable Array<IndexEntry> _unindexed;
+	mutable bool _indexed;
+
+	void ensureIndexed() const; //!< Build the name index if it is not up to date.
+	const IndexEntry *lookupIndex(const Path &path) const;
+
 public:
-	SearchSet() : _ignoreClashes(false) { }
+	SearchSet() : _ignoreClashes(false), _indexed(false) { }
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -251,6 +282,19 @@ public:
 	 */
 	void setPriority(const String& name, int priority);
 
+	/**
+	 * Drop the merged name index, so that it is rebuilt on the next lookup.
+	 * Adding, removing and reordering archives does this automatically. Call
+	 * it after the members of an archive in the set have changed, e.g. after
+	 * @ref FSDirectory::invalidateCache.
+	 */
+	void invalidateIndex();
+
+	/**
+	 * Check if any archive in the set has the file. Archives listing their
+	 * members are looked up with a single probe of a merged index, and a hit
+	 * is confirmed by the archive which the index points to.
+	 */
 	bool hasFile(const Path &path) const override;
 	int listMatchingMembers(ArchiveMemberList &list, const Path &pattern) const override;
 	int listMembers(ArchiveMemberList &list) const override;
@@ -20,7 +20,7 @@
  */
 
 #include "common/dcl.h"
-#include "common/debug.h"
+#include "common/endian.h"
 #include "common/memstream.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
@@ -29,87 +29,135 @@ namespace Common {
 
 class DecompressorDCL {
 public:
-	bool unpack(SeekableReadStream *sourceStream, WriteStream *targetStream, uint32 targetSize, bool targetFixedSize);
+	/**
+	 * @param src		compressed data, which has to stay valid while unpacking
+	 * @param srcSize	size of the compressed data
+	 */
+	DecompressorDCL(const byte *src, uint32 srcSize);
+
+	/**
+	 * Unpack into a buffer of fixed size, which has to be filled completely.
+	 */
+	bool unpack(byte *dest, uint32 targetSize);
+
+	/**
+	 * Unpack data of unknown size.
+	 * @return a malloc'ed buffer with the unpacked data, or 0 on errors
+	 */
+	byte *unpack(uint32 &unpackedSize);
 
 protected:
+	enum {
+		kTableBits = 8,
+		kTableSize = 1 << kTableBits,
+		kMaxTokenLength = 518,
+		kEndOfStream = 519
+	};
+
+	bool unpack(bool targetFixedSize);
+
 	/**
-	 * Initialize decompressor.
-	 * @param sourceStream	source stream to read from
-	 * @param targetStream	target memory stream to write to
+	 * Fill the bit buffer so that it holds at least 56 bits, which is
+	 * enough for any token. Past the end of the source, zeros are read
+	 * in, like reading the source stream did.
 	 */
-	void init(SeekableReadStream *sourceStream, WriteStream *targetStream, uint32 targetSize, bool targetFixedSize);
+	void refillBits();
 
 	/**
-	 * Get a number of bits from _src stream, starting with the least
-	 * significant unread bit of the current four byte block.
+	 * Get a number of bits from the bit buffer, starting with the least
+	 * significant unread bit.
 	 * @param n		number of bits to get
 	 * @return n-bits number
 	 */
-	uint32 getBitsLSB(int n);
+	uint32 getBits(int n) {
+		uint32 ret = (uint32)_bitBuffer & ((1 << n) - 1);
+		_bitBuffer >>= n;
+		_bitCount -= n;
+		return ret;
+	}
 
 	/**
-	 * Get one byte from _src stream.
-	 * @return byte
+	 * Fill a lookup table indexed by the next kTableBits input bits with
+	 * the codes of a Huffman tree, starting at the given tree node.
 	 */
-	byte getByteLSB();
+	static void buildTable(const int *tree, uint16 *table, int pos, int depth, uint prefix);
+
+	int huffmanLookup(const uint16 *table, const int *tree);
 
-	void fetchBitsLSB();
+	/**
+	 * Make room for the longest token in a dynamically sized target.
+	 */
+	bool reserve(uint32 size);
 
 	/**
-	 * Write one byte into _dest stream
-	 * @param b byte to put
+	 * Copy an earlier part of the output. If the copy overlaps itself, it
+	 * repeats the last offset bytes, like copying byte by byte would.
 	 */
-	void putByte(byte b);
-
-	int huffman_lookup(const int *tree);
-
-	uint32 _dwBits;			///< bits buffer
-	byte _nBits;			///< number of unread bits in _dwBits
-	uint32 _sourceSize;		///< size of the source stream
-	uint32 _targetSize;		///< size of the target stream (if fixed)
-	bool _targetFixedSize;  ///< if target stream is fixed size or dynamic size
-	uint32 _bytesRead;		///< number of bytes read from _sourceStream
-	uint32 _bytesWritten;	///< number of bytes written to _targetStream
-	SeekableReadStream *_sourceStream;
-	WriteStream *_targetStream;
+	void copyMatch(uint32 offset, uint32 length);
+
+	const byte *_src;
+	uint32 _srcSize;
+	uint32 _srcPos;			///< number of bytes moved into _bitBuffer, including zeros past the end
+	uint64 _bitBuffer;
+	uint _bitCount;			///< number of unread bits in _bitBuffer
+	byte *_dest;
+	uint32 _targetSize;		///< size of the target buffer
+	uint32 _bytesWritten;	///< number of bytes written to _dest
+
+	uint16 _lengthTable[kTableSize];
+	uint16 _distanceTable[kTableSize];
+	uint16 _asciiTable[kTableSize];
 };
 
-void DecompressorDCL::init(SeekableReadStream *sourceStream, WriteStream *targetStream, uint32 targetSize, bool targetFixedSize) {
-	_sourceStream = sourceStream;
-	_targetStream = targetStream;
-	_sourceSize = sourceStream->size();
-	_targetSize = targetSize;
-	_targetFixedSize = targetFixedSize;
-	_nBits = 0;
-	_bytesRead = _bytesWritten = 0;
-	_dwBits = 0;
+DecompressorDCL::DecompressorDCL(const byte *src, uint32 srcSize)
+	: _src(src), _srcSize(srcSize), _srcPos(0), _bitBuffer(0), _bitCount(0),
+	  _dest(nullptr), _targetSize(0), _bytesWritten(0) {
 }
 
-void DecompressorDCL::fetchBitsLSB() {
-	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_sourceStream->readByte()) << _nBits;
-		_nBits += 8;
-		_bytesRead++;
+void DecompressorDCL::refillBits() {
+	if (_srcPos + 8 <= _srcSize) {
+		// Load eight bytes at once and keep as many whole ones as fit. Bits
+		// above _bitCount are either zero or the same data again.
+		_bitBuffer |= READ_LE_UINT64(_src + _srcPos) << _bitCount;
+		_srcPos += (63 - _bitCount) >> 3;
+		_bitCount |= 56;
+	} else {
+		while (_bitCount <= 56) {
+			if (_srcPos < _srcSize)
+				_bitBuffer |= (uint64)_src[_srcPos] << _bitCount;
+			_srcPos++;
+			_bitCount += 8;
+		}
 	}
 }
 
-uint32 DecompressorDCL::getBitsLSB(int n) {
-	// Fetching more data to buffer if needed
-	if (_nBits < n)
-		fetchBitsLSB();
-	uint32 ret = (_dwBits & ~(~0UL << n));
-	_dwBits >>= n;
-	_nBits -= n;
-	return ret;
-}
+bool DecompressorDCL::reserve(uint32 size) {
+	if (_bytesWritten + size <= _targetSize)
+		return true;
 
-byte DecompressorDCL::getByteLSB() {
-	return getBitsLSB(8);
+	uint32 newSize = MAX<uint32>(_targetSize * 2, _bytesWritten + size);
+	byte *newDest = (byte *)realloc(_dest, newSize);
+	if (!newDest)
+		return false;
+	_dest = newDest;
+	_targetSize = newSize;
+	return true;
 }
 
-void DecompressorDCL::putByte(byte b) {
-	_targetStream->writeByte(b);
-	_bytesWritten++;
+void DecompressorDCL::copyMatch(uint32 offset, uint32 length) {
+	const byte *src = _dest + _bytesWritten - offset;
+	byte *dst = _dest + _bytesWritten;
+	_bytesWritten += length;
+
+	// Each copy doubles the repeated part, so the next one can be twice as
+	// long without overlapping
+	while (length > offset) {
+		memcpy(dst, src, offset);
+		dst += offset;
+		length -= offset;
+		offset *= 2;
+	}
+	memcpy(dst, src, length);
 }
 
 #define HUFFMAN_LEAF 0x40000000
@@ -315,87 +363,102 @@ static const int ascii_tree[] = {
 	LN(509, 128)      LN(510, 26)
 };
 
-int DecompressorDCL::huffman_lookup(const int *tree) {
-	int pos = 0;
+void DecompressorDCL::buildTable(const int *tree, uint16 *table, int pos, int depth, uint prefix) {
+	if (tree[pos] & HUFFMAN_LEAF) {
+		// Short codes fill every entry which starts with their bits. The
+		// code length goes into the top bits.
+		for (uint i = prefix; i < kTableSize; i += 1 << depth)
+			table[i] = (depth << 12) | (tree[pos] & 0xFFF);
+	} else if (depth == kTableBits) {
+		// Longer codes continue from this node, bit by bit
+		table[prefix] = pos;
+	} else {
+		buildTable(tree, table, tree[pos] >> 12, depth + 1, prefix);
+		buildTable(tree, table, tree[pos] & 0xFFF, depth + 1, prefix | (1 << depth));
+	}
+}
 
-	while (!(tree[pos] & HUFFMAN_LEAF)) {
-		int bit = getBitsLSB(1);
-		debug(8, "[%d]:%d->", pos, bit);
-		pos = bit ? tree[pos] & 0xFFF : tree[pos] >> 12;
+int DecompressorDCL::huffmanLookup(const uint16 *table, const int *tree) {
+	const uint16 entry = table[_bitBuffer & (kTableSize - 1)];
+	if (entry >> 12) {
+		getBits(entry >> 12);
+		return entry & 0xFFF;
 	}
 
-	debug(8, "=%02x\n", tree[pos] & 0xffff);
-	return tree[pos] & 0xFFFF;
+	// Only literals in ASCII mode have codes longer than the table
+	getBits(kTableBits);
+	int pos = entry;
+	while (!(tree[pos] & HUFFMAN_LEAF))
+		pos = getBits(1) ? tree[pos] & 0xFFF : tree[pos] >> 12;
+	return tree[pos] & 0xFFF;
 }
 
 #define DCL_BINARY_MODE 0
 #define DCL_ASCII_MODE 1
 
-#define MIDI_SETUP_BUNDLE_FILE_MAXIMUM_DICTIONARY_SIZE 4096
-
-bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, WriteStream *targetStream, uint32 targetSize, bool targetFixedSize) {
-	byte   dictionary[MIDI_SETUP_BUNDLE_FILE_MAXIMUM_DICTIONARY_SIZE];
-	uint16 dictionaryPos = 0;
-	uint16 dictionarySize = 0;
-	uint16 dictionaryMask = 0;
-	int value;
-	uint16 tokenOffset = 0;
-	uint16 tokenLength = 0;
-
-	init(sourceStream, targetStream, targetSize, targetFixedSize);
-
-	byte mode = getByteLSB();
-	byte dictionaryType = getByteLSB();
+bool DecompressorDCL::unpack(bool targetFixedSize) {
+	refillBits();
+	byte mode = getBits(8);
+	byte dictionaryType = getBits(8);
 
 	if (mode != DCL_BINARY_MODE && mode != DCL_ASCII_MODE) {
 		warning("DCL-INFLATE: Error: Encountered mode %02x, expected 00 or 01", mode);
 		return false;
 	}
 
+	// Dictionary types 4, 5 and 6 stand for 1024, 2048 and 4096 bytes. The
+	// output itself serves as dictionary, since no offset can reach further.
 	// TODO: original code supported 3 as well???
 	// Was this an accident or on purpose? And the original code did just give out a warning
 	// and didn't error out at all
-	switch (dictionaryType) {
-	case 4:
-		dictionarySize = 1024;
-		break;
-	case 5:
-		dictionarySize = 2048;
-		break;
-	case 6:
-		dictionarySize = 4096;
-		break;
-	default:
+	if (dictionaryType < 4 || dictionaryType > 6) {
 		warning("DCL-INFLATE: Error: unsupported dictionary type %02x", dictionaryType);
 		return false;
 	}
-	dictionaryMask = dictionarySize - 1;
+
+	buildTable(length_tree, _lengthTable, 0, 0, 0);
+	buildTable(distance_tree, _distanceTable, 0, 0, 0);
+	if (mode == DCL_ASCII_MODE)
+		buildTable(ascii_tree, _asciiTable, 0, 0, 0);
 
 	while ((!targetFixedSize) || (_bytesWritten < _targetSize)) {
-		if (getBitsLSB(1)) { // (length,distance) pair
-			value = huffman_lookup(length_tree);
+		// One refill covers the longest token
+		refillBits();
+
+		if (!targetFixedSize) {
+			// Without a known size, only the end marker stops unpacking
+			if (_srcPos > _srcSize && (_srcPos - _srcSize) * 8 > _bitCount) {
+				warning("DCL-INFLATE Error: Unexpected end of input (%d bytes written)", _bytesWritten);
+				return false;
+			}
+			if (!reserve(kMaxTokenLength)) {
+				warning("DCL-INFLATE Error: Out of memory after %d bytes", _bytesWritten);
+				return false;
+			}
+		}
+
+		if (getBits(1)) { // (length,distance) pair
+			int value = huffmanLookup(_lengthTable, length_tree);
+			uint32 tokenLength;
 
 			if (value < 8)
 				tokenLength = value + 2;
 			else
-				tokenLength = 8 + (1 << (value - 7)) + getBitsLSB(value - 7);
+				tokenLength = 8 + (1 << (value - 7)) + getBits(value - 7);
 
-			if (tokenLength == 519)
+			if (tokenLength == kEndOfStream)
 				break; // End of stream signal
 
-			debug(8, " | ");
-
-			value = huffman_lookup(distance_tree);
+			value = huffmanLookup(_distanceTable, distance_tree);
 
+			uint32 tokenOffset;
 			if (tokenLength == 2)
-				tokenOffset = (value << 2) | getBitsLSB(2);
+				tokenOffset = (value << 2) | getBits(2);
 			else
-				tokenOffset = (value << dictionaryType) | getBitsLSB(dictionaryType);
+				tokenOffset = (value << dictionaryType) | getBits(dictionaryType);
 			tokenOffset++;
 
-			debug(8, "\nCOPY(%d from %d)\n", tokenLength, tokenOffset);
-
-			if (_targetFixedSize) {
+			if (targetFixedSize) {
 				if (tokenLength + _bytesWritten > _targetSize) {
 					warning("DCL-INFLATE Error: Write out of bounds while copying %d bytes (declared unpacked size is %d bytes, current is %d + %d bytes)",
 							tokenLength, _targetSize, _bytesWritten, tokenLength);
@@ -409,45 +472,13 @@ bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, WriteStream *targ
 				return false;
 			}
 
-			uint16 dictionaryBaseIndex = (dictionaryPos - tokenOffset) & dictionaryMask;
-			uint16 dictionaryIndex = dictionaryBaseIndex;
-			uint16 dictionaryNextIndex = dictionaryPos;
-
-			while (tokenLength) {
-				// Write byte from dictionary
-				putByte(dictionary[dictionaryIndex]);
-				debug(9, "\33[32;31m%02x\33[37;37m ", dictionary[dictionaryIndex]);
-
-				dictionary[dictionaryNextIndex] = dictionary[dictionaryIndex];
-
-				dictionaryNextIndex = (dictionaryNextIndex + 1) & dictionaryMask;
-				dictionaryIndex = (dictionaryIndex + 1) & dictionaryMask;
-
-				if (dictionaryIndex == dictionaryPos)
-					dictionaryIndex = dictionaryBaseIndex;
-				if (dictionaryNextIndex == dictionarySize)
-					dictionaryNextIndex = 0;
-
-				tokenLength--;
-			}
-			dictionaryPos = dictionaryNextIndex;
-			debug(9, "\n");
-
+			copyMatch(tokenOffset, tokenLength);
 		} else { // Copy byte verbatim
-			value = (mode == DCL_ASCII_MODE) ? huffman_lookup(ascii_tree) : getByteLSB();
-			putByte(value);
-
-			// Also remember it inside dictionary
-			dictionary[dictionaryPos] = value;
-			dictionaryPos++;
-			if (dictionaryPos >= dictionarySize)
-				dictionaryPos = 0;
-
-			debug(9, "\33[32;31m%02x \33[37;37m", value);
+			_dest[_bytesWritten++] = (mode == DCL_ASCII_MODE) ? huffmanLookup(_asciiTable, ascii_tree) : getBits(8);
 		}
 	}
 
-	if (_targetFixedSize) {
+	if (targetFixedSize) {
 		if (_bytesWritten != _targetSize)
 			warning("DCL-INFLATE Error: Inconsistent bytes written (%d) and target buffer size (%d)", _bytesWritten, _targetSize);
 		return _bytesWritten == _targetSize;
@@ -455,10 +486,27 @@ bool DecompressorDCL::unpack(SeekableReadStream *sourceStream, WriteStream *targ
 	return true; // For targets featuring dynamic size we always succeed
 }
 
-bool decompressDCL(ReadStream *src, byte *dest, uint32 packedSize, uint32 unpackedSize) {
-	bool success = false;
-	DecompressorDCL dcl;
+bool DecompressorDCL::unpack(byte *dest, uint32 targetSize) {
+	_dest = dest;
+	_targetSize = targetSize;
+	return unpack(true);
+}
 
+byte *DecompressorDCL::unpack(uint32 &unpackedSize) {
+	// A first guess, the buffer grows as needed
+	_targetSize = MAX<uint32>(_srcSize * 4, 4096);
+	_dest = (byte *)malloc(_targetSize);
+	if (!_dest || !unpack(false)) {
+		free(_dest);
+		return nullptr;
+	}
+
+	unpackedSize = _bytesWritten;
+	byte *shrunk = (byte *)realloc(_dest, MAX<uint32>(_bytesWritten, 1));
+	return shrunk ? shrunk : _dest;
+}
+
+bool decompressDCL(ReadStream *src, byte *dest, uint32 packedSize, uint32 unpackedSize) {
 	if (!src || !dest)
 		return false;
 
@@ -467,33 +515,20 @@ bool decompressDCL(ReadStream *src, byte *dest, uint32 packedSize, uint32 unpack
 		return false;
 
 	// Read source into memory
-	src->read(sourceBufferPtr, packedSize);
-
-	Common::MemoryReadStream  *sourceStream = new MemoryReadStream(sourceBufferPtr, packedSize, DisposeAfterUse::YES);
-	Common::MemoryWriteStream *targetStream = new MemoryWriteStream(dest, unpackedSize);
+	uint32 sourceSize = src->read(sourceBufferPtr, packedSize);
 
-	success = dcl.unpack(sourceStream, targetStream, unpackedSize, true);
-	delete sourceStream;
-	delete targetStream;
+	DecompressorDCL dcl(sourceBufferPtr, sourceSize);
+	bool success = dcl.unpack(dest, unpackedSize);
+	free(sourceBufferPtr);
 	return success;
 }
 
 SeekableReadStream *decompressDCL(SeekableReadStream *sourceStream, uint32 packedSize, uint32 unpackedSize) {
-	bool success = false;
-	byte *targetPtr = nullptr;
-	Common::MemoryWriteStream *targetStream;
-	DecompressorDCL dcl;
-
-	targetPtr = (byte *)malloc(unpackedSize);
+	byte *targetPtr = (byte *)malloc(unpackedSize);
 	if (!targetPtr)
 		return nullptr;
 
-	targetStream = new MemoryWriteStream(targetPtr, unpackedSize);
-
-	success = dcl.unpack(sourceStream, targetStream, unpackedSize, true);
-	delete targetStream;
-
-	if (!success) {
+	if (!decompressDCL(sourceStream, targetPtr, packedSize, unpackedSize)) {
 		free(targetPtr);
 		return nullptr;
 	}
@@ -503,19 +538,21 @@ SeekableReadStream *decompressDCL(SeekableReadStream *sourceStream, uint32 packe
 // This one figures out the unpacked size by itself
 // Needed for at least Simon 2, because the unpacked size is not stored anywhere
 SeekableReadStream *decompressDCL(SeekableReadStream *sourceStream) {
-	Common::MemoryWriteStreamDynamic *targetStream;
-	DecompressorDCL dcl;
+	// The packed data ends with the stream
+	uint32 packedSize = sourceStream->size() - sourceStream->pos();
+	byte *sourceBufferPtr = (byte *)malloc(MAX<uint32>(packedSize, 1));
+	if (!sourceBufferPtr)
+		return nullptr;
+	packedSize = sourceStream->read(sourceBufferPtr, packedSize);
 
-	targetStream = new MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+	DecompressorDCL dcl(sourceBufferPtr, packedSize);
+	uint32 unpackedSize = 0;
+	byte *targetPtr = dcl.unpack(unpackedSize);
+	free(sourceBufferPtr);
 
-	if (dcl.unpack(sourceStream, targetStream, 0, false)) {
-		byte *targetPtr = targetStream->getData();
-		uint32 unpackedSize = targetStream->size();
-		delete targetStream;
-		return new MemoryReadStream(targetPtr, unpackedSize, DisposeAfterUse::YES);
-	}
-	delete targetStream;
-	return nullptr;
+	if (!targetPtr)
+		return nullptr;
+	return new MemoryReadStream(targetPtr, unpackedSize, DisposeAfterUse::YES);
 }
 
 } // End of namespace Common
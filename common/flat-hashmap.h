@@ -0,0 +1,584 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_FLAT_HASHMAP_H
+#define COMMON_FLAT_HASHMAP_H
+
+#include "common/hashmap.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_flat_hashmap Flat hash table (FlatHashMap)
+ * @ingroup common
+ *
+ * @brief API for operations on an open addressing hash table.
+ *
+ * @{
+ */
+
+/**
+ * FlatHashMap<Key,Val> has the same interface as HashMap<Key,Val>, but
+ * stores the nodes inline in one array instead of allocating each of them.
+ * A separate array holds one control byte per slot: either empty, erased, or
+ * seven bits of the key's hash. Lookups probe linearly through the control
+ * bytes and only compare keys whose hash bits match, so a lookup usually
+ * touches one control byte cache line and one node.
+ *
+ * Unlike HashMap, inserting a new key may move the existing nodes, which
+ * invalidates pointers and references to them. Erasing does not move nodes,
+ * so it is safe to erase the current entry while iterating.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+	struct Node {
+		Val _value;
+		const Key _key;
+		explicit Node(const Key &key) : _value(), _key(key) {}
+	};
+
+private:
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// The map grows once this fraction of the slots is used or erased.
+		// Linear probing gets slow quickly beyond that.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 3,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 4,
+
+		// Control bytes. Used slots hold the top seven bits of the hash.
+		FLATHASHMAP_EMPTY = 0x80,
+		FLATHASHMAP_ERASED = 0xFE
+	};
+
+	/** Default value, returned by the const getVal. */
+	Val _defaultVal;
+
+	byte *_ctrl;        ///< Control byte of each slot
+	Node *_slots;       ///< Uninitialized memory for mask + 1 nodes
+	size_type _mask;    ///< Capacity of the map minus one; the capacity is a power of two
+	size_type _size;
+	size_type _erased;  ///< Number of erased slots
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	static bool isUsed(byte ctrl) { return !(ctrl & 0x80); }
+
+	/**
+	 * Spread the hash over all bits, since the integer hashes are the
+	 * identity. The top bits become the control byte, the rest the slot.
+	 */
+	static uint32 mixHash(size_type hash) { return (uint32)hash * 0x9E3779B1; }
+	static byte hashTag(uint32 mixed) { return (byte)(mixed >> 25); }
+	size_type hashSlot(uint32 mixed) const { return (mixed ^ (mixed >> 15)) & _mask; }
+
+	void allocStorage(size_type capacity);
+	void freeStorage();
+	void assign(const FHM_t &map);
+	size_type lookup(const Key &key) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	void rehash(size_type newCapacity);
+	void eraseSlot(size_type ctr);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != nullptr);
+			assert(_idx <= _hashmap->_mask);
+			assert(isUsed(_hashmap->_ctrl[_idx]));
+			return &_hashmap->_slots[_idx];
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(nullptr) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			do {
+				_idx++;
+			} while (_idx <= _hashmap->_mask && !isUsed(_hashmap->_ctrl[_idx]));
+			if (_idx > _hashmap->_mask)
+				_idx = (size_type)-1;
+
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		freeStorage();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getOrCreateVal(const Key &key);
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getValOrDefault(const Key &key) const;
+	const Val &getValOrDefault(const Key &key, const Val &defaultVal) const;
+	bool tryGetVal(const Key &key, Val &out) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	size_type size() const { return _size; }
+
+	iterator	begin() {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (isUsed(_ctrl[ctr]))
+				return iterator(ctr, this);
+		}
+		return end();
+	}
+	iterator	end() {
+		return iterator((size_type)-1, this);
+	}
+
+	const_iterator	begin() const {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (isUsed(_ctrl[ctr]))
+				return const_iterator(ctr, this);
+		}
+		return end();
+	}
+	const_iterator	end() const {
+		return const_iterator((size_type)-1, this);
+	}
+
+	iterator	find(const Key &key) {
+		size_type ctr = lookup(key);
+		if (isUsed(_ctrl[ctr]))
+			return iterator(ctr, this);
+		return end();
+	}
+
+	const_iterator	find(const Key &key) const {
+		size_type ctr = lookup(key);
+		if (isUsed(_ctrl[ctr]))
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	/** Return true if hashmap is empty. */
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+/**
+ * Base constructor, creates an empty hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+}
+
+/**
+ * Copy constructor, creates a full copy of the given hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+/**
+ * Destructor, frees all used memory.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	freeStorage();
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	_mask = capacity - 1;
+	_ctrl = new byte[capacity];
+	memset(_ctrl, FLATHASHMAP_EMPTY, capacity);
+	_slots = (Node *)malloc(capacity * sizeof(Node));
+	assert(_slots != nullptr);
+	_size = 0;
+	_erased = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isUsed(_ctrl[ctr]))
+			_slots[ctr].~Node();
+	}
+	delete[] _ctrl;
+	free(_slots);
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one. The nodes keep their slots.
+ *
+ * @note The previous storage here is *not* deallocated here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	allocStorage(map._mask + 1);
+	memcpy(_ctrl, map._ctrl, _mask + 1);
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isUsed(_ctrl[ctr])) {
+			new (&_slots[ctr]) Node(map._slots[ctr]._key);
+			_slots[ctr]._value = map._slots[ctr]._value;
+		}
+	}
+	_size = map._size;
+	_erased = map._erased;
+}
+
+/**
+ * Clear all values in the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		freeStorage();
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+		return;
+	}
+
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isUsed(_ctrl[ctr]))
+			_slots[ctr].~Node();
+	}
+	memset(_ctrl, FLATHASHMAP_EMPTY, _mask + 1);
+	_size = 0;
+	_erased = 0;
+}
+
+/**
+ * Move all nodes into storage of the given capacity. This also drops the
+ * erased slots, so it is used at the same capacity when those fill the map.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::rehash(size_type newCapacity) {
+	assert(newCapacity > _size);
+
+	const size_type old_mask = _mask;
+	byte *old_ctrl = _ctrl;
+	Node *old_slots = _slots;
+#ifndef NDEBUG
+	const size_type old_size = _size;
+#endif
+
+	allocStorage(newCapacity);
+
+	for (size_type ctr = 0; ctr <= old_mask; ++ctr) {
+		if (!isUsed(old_ctrl[ctr]))
+			continue;
+
+		// The keys are known to be unique, so there is no need to compare them
+		Node &node = old_slots[ctr];
+		const uint32 mixed = mixHash(_hash(node._key));
+		size_type idx = hashSlot(mixed);
+		while (_ctrl[idx] != FLATHASHMAP_EMPTY)
+			idx = (idx + 1) & _mask;
+
+		_ctrl[idx] = hashTag(mixed);
+		new (&_slots[idx]) Node(node._key);
+		_slots[idx]._value = node._value;
+		node.~Node();
+		_size++;
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	assert(_size == old_size);
+
+	delete[] old_ctrl;
+	free(old_slots);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+	const uint32 mixed = mixHash(_hash(key));
+	const byte tag = hashTag(mixed);
+	size_type ctr = hashSlot(mixed);
+
+	// There is always at least one empty slot, which ends the probe
+	for (;;) {
+		const byte ctrl = _ctrl[ctr];
+		if (ctrl == FLATHASHMAP_EMPTY)
+			break;
+		if (ctrl == tag && _equal(_slots[ctr]._key, key))
+			break;
+		ctr = (ctr + 1) & _mask;
+	}
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	const uint32 mixed = mixHash(_hash(key));
+	const byte tag = hashTag(mixed);
+	size_type ctr = hashSlot(mixed);
+	const size_type NONE_FOUND = _mask + 1;
+	size_type first_free = NONE_FOUND;
+
+	for (;;) {
+		const byte ctrl = _ctrl[ctr];
+		if (ctrl == FLATHASHMAP_EMPTY)
+			break;
+		if (ctrl == FLATHASHMAP_ERASED) {
+			if (first_free == NONE_FOUND)
+				first_free = ctr;
+		} else if (ctrl == tag && _equal(_slots[ctr]._key, key)) {
+			return ctr;
+		}
+		ctr = (ctr + 1) & _mask;
+	}
+
+	// Reuse the first erased slot of the probe, if any
+	if (first_free != NONE_FOUND) {
+		ctr = first_free;
+		_erased--;
+	}
+
+	_ctrl[ctr] = tag;
+	new (&_slots[ctr]) Node(key);
+	_size++;
+
+	// Keep the load factor below a certain threshold.
+	// Erased slots are also counted
+	size_type capacity = _mask + 1;
+	if ((_size + _erased) * FLATHASHMAP_LOADFACTOR_DENOMINATOR >
+	        capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR) {
+		// Mostly erased slots only need cleaning up
+		if (_size * 2 * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+			capacity = capacity < 500 ? (capacity * 4) : (capacity * 2);
+		rehash(capacity);
+		ctr = lookup(key);
+		assert(isUsed(_ctrl[ctr]));
+	}
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type ctr) {
+	_slots[ctr].~Node();
+	_size--;
+
+	// A slot followed by an empty one ends no probe sequence of another
+	// key, so it can become empty again instead of erased.
+	if (_ctrl[(ctr + 1) & _mask] == FLATHASHMAP_EMPTY) {
+		_ctrl[ctr] = FLATHASHMAP_EMPTY;
+	} else {
+		_ctrl[ctr] = FLATHASHMAP_ERASED;
+		_erased++;
+	}
+}
+
+/**
+ * Check whether the hashmap contains the given key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return isUsed(_ctrl[lookup(key)]);
+}
+
+/**
+ * Get a value from the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getOrCreateVal(key);
+}
+
+/**
+ * @overload
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+/**
+ * Get a value from the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getOrCreateVal(const Key &key) {
+	// The lookup may move the slots, so it has to happen first
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	return _slots[ctr]._value;
+}
+
+/**
+ * @overload
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	size_type ctr = lookup(key);
+	if (isUsed(_ctrl[ctr]))
+		return _slots[ctr]._value;
+	else
+		// See the comment in HashMap::getVal().
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	size_type ctr = lookup(key);
+	if (isUsed(_ctrl[ctr]))
+		return _slots[ctr]._value;
+	else
+		// See the comment in HashMap::getVal().
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getValOrDefault(const Key &key) const {
+	return getValOrDefault(key, _defaultVal);
+}
+
+/**
+ * Get a value from the hashmap. If the key is not present, then return @p defaultVal.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getValOrDefault(const Key &key, const Val &defaultVal) const {
+	size_type ctr = lookup(key);
+	if (isUsed(_ctrl[ctr]))
+		return _slots[ctr]._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::tryGetVal(const Key &key, Val &out) const {
+	size_type ctr = lookup(key);
+	if (isUsed(_ctrl[ctr])) {
+		out = _slots[ctr]._value;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+ * Assign an element specified by @p key to a value @p val.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	const size_type ctr = lookupAndCreateIfMissing(key);
+	_slots[ctr]._value = val;
+}
+
+/**
+ * Erase an element referred to by an iterator.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	const size_type ctr = entry._idx;
+	assert(ctr <= _mask);
+	assert(isUsed(_ctrl[ctr]));
+
+	eraseSlot(ctr);
+}
+
+/**
+ * Erase an element specified by a key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	size_type ctr = lookup(key);
+	if (isUsed(_ctrl[ctr]))
+		eraseSlot(ctr);
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
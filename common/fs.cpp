@@ -126,6 +126,10 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+bool FSNode::getFileStat(int64 &size, int64 &modificationTime) const {
+	return _realNode && _realNode->getFileStat(size, modificationTime);
+}
+
 SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -333,6 +337,12 @@ void FSDirectory::ensureCached() const  {
 	_cached = true;
 }
 
+void FSDirectory::invalidateCache() {
+	_fileCache.clear();
+	_subDirCache.clear();
+	_cached = false;
+}
+
 int FSDirectory::listMatchingMembers(ArchiveMemberList &list, const Path &pattern) const {
 	if (!_node.isDirectory())
 		return 0;
@@ -390,5 +400,18 @@ int FSDirectory::listMembers(ArchiveMemberList &list) const {
 	return files;
 }
 
+bool FSDirectory::listMemberPaths(Array<String> &paths) const {
+	if (!_node.isDirectory())
+		return true;
+
+	ensureCached();
+
+	paths.reserve(paths.size() + _fileCache.size());
+	for (NodeCache::const_iterator it = _fileCache.begin(); it != _fileCache.end(); ++it)
+		paths.push_back(it->_key);
+
+	return true;
+}
+
 
 } // End of namespace Common
@@ -223,6 +223,15 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Get the size and the time of the last modification of the file
+	 * referred by this node, without opening it. The time is only meant
+	 * for noticing changes, not for display.
+	 *
+	 * @return True if the node is a file and the backend can tell both.
+	 */
+	bool getFileStat(int64 &size, int64 &modificationTime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -368,7 +377,8 @@ public:
 
 	/**
 	 * Check for the existence of a file in the cache. A full match of relative path and file name
-	 * is needed for success.
+	 * is needed for success. A cached file is checked to still exist, but files added after
+	 * the cache was built are only noticed after invalidateCache().
 	 */
 	bool hasFile(const Path &path) const override;
 
@@ -382,6 +392,16 @@ public:
 	 */
 	int listMembers(ArchiveMemberList &list) const override;
 
+	/**
+	 * Return the relative paths of all the files in the cache.
+	 */
+	bool listMemberPaths(Array<String> &paths) const override;
+
+	/**
+	 * Drop the cached directory tree, so that it is read again on the next lookup.
+	 */
+	void invalidateCache();
+
 	/**
 	 * Get an ArchiveMember representation of the specified file. A full match of relative
 	 * path and file name is needed for success.
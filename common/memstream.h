@@ -28,6 +28,8 @@
 
 namespace Common {
 
+template <typename ValueType> class Span;
+
 /**
  * @defgroup common_memory_pool Memory stream
  * @ingroup common_memory
@@ -49,6 +51,11 @@ private:
 	DisposeAfterUse::Flag _disposeMemory;
 	bool _eos;
 
+	// Defined in common/span.h
+	friend Span<const byte> readSpan(MemoryReadStream &stream, uint32 dataSize);
+
+	uint32 beginArrayRead(uint32 count, uint32 valueSize);
+
 public:
 
 	/**
@@ -78,6 +85,21 @@ public:
 	int64 size() const { return _size; }
 
 	bool seek(int64 offs, int whence = SEEK_SET);
+
+	/**
+	 * Read an array of little or big endian values and convert them to the
+	 * native byte order. On little endian systems, reading little endian
+	 * values is a single copy, and the other way around.
+	 *
+	 * Only whole values are read. If fewer than count are left, the
+	 * remaining ones are read and eos is set.
+	 *
+	 * @return The number of values read.
+	 */
+	uint32 readUint16LEArray(uint16 *dst, uint32 count);
+	uint32 readUint16BEArray(uint16 *dst, uint32 count); //!< @copydoc readUint16LEArray
+	uint32 readUint32LEArray(uint32 *dst, uint32 count); //!< @copydoc readUint16LEArray
+	uint32 readUint32BEArray(uint32 *dst, uint32 count); //!< @copydoc readUint16LEArray
 };
 
 
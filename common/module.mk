@@ -29,6 +29,7 @@ MODULE_OBJS := \
 	osd_message_queue.o \
 	path.o \
 	platform.o \
+	prefetchstream.o \
 	punycode.o \
 	quicktime.o \
 	random.o \
@@ -0,0 +1,288 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/prefetchstream.h"
+#include "common/algorithm.h"
+#include "common/array.h"
+#include "common/list.h"
+#include "common/singleton.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/timer.h"
+
+namespace Common {
+
+/**
+ * Runs prefetch() for all streams in background mode from a single timer
+ * callback. The timer is installed with the first stream and kept until
+ * the scheduler is destroyed.
+ */
+class PrefetchScheduler : public Singleton<PrefetchScheduler> {
+public:
+	void add(PrefetchingReadStream *stream);
+	void remove(PrefetchingReadStream *stream);
+
+private:
+	friend class Singleton<SingletonBaseType>;
+	PrefetchScheduler();
+	~PrefetchScheduler() override;
+
+	static void timerProc(void *refCon);
+	void prefetchAll();
+
+	// Only guards the list. The callback fills each stream under its
+	// _callbackMutex instead, so that remove() only waits for the stream it
+	// removes, and not for the disk reads of all other streams.
+	Mutex _mutex;
+	List<PrefetchingReadStream *> _streams;
+};
+
+DECLARE_SINGLETON(PrefetchScheduler);
+
+PrefetchScheduler::PrefetchScheduler() {
+	g_system->getTimerManager()->installTimerProc(&timerProc, 10000, this, "PrefetchScheduler");
+}
+
+PrefetchScheduler::~PrefetchScheduler() {
+	g_system->getTimerManager()->removeTimerProc(&timerProc);
+}
+
+void PrefetchScheduler::add(PrefetchingReadStream *stream) {
+	StackLock lock(_mutex);
+	_streams.push_back(stream);
+}
+
+void PrefetchScheduler::remove(PrefetchingReadStream *stream) {
+	{
+		StackLock lock(_mutex);
+		_streams.remove(stream);
+	}
+	// The callback takes the stream's lock before it lets go of the list,
+	// so this waits for a fill which is still going on
+	StackLock lock(stream->_callbackMutex);
+}
+
+void PrefetchScheduler::timerProc(void *refCon) {
+	((PrefetchScheduler *)refCon)->prefetchAll();
+}
+
+void PrefetchScheduler::prefetchAll() {
+	Array<PrefetchingReadStream *> streams;
+	{
+		StackLock lock(_mutex);
+		for (List<PrefetchingReadStream *>::iterator it = _streams.begin(); it != _streams.end(); ++it)
+			streams.push_back(*it);
+	}
+
+	for (uint i = 0; i < streams.size(); i++) {
+		PrefetchingReadStream *stream = streams[i];
+		{
+			// Streams removed since the list was copied may be gone already
+			StackLock lock(_mutex);
+			if (find(_streams.begin(), _streams.end(), stream) == _streams.end())
+				continue;
+			stream->_callbackMutex.lock();
+		}
+		stream->prefetch();
+		stream->_callbackMutex.unlock();
+	}
+}
+
+PrefetchingReadStream::PrefetchingReadStream(SeekableReadStream *parentStream, uint32 chunkSize, uint depth, DisposeAfterUse::Flag disposeParentStream)
+	: _parentStream(parentStream, disposeParentStream),
+	_chunkSize(chunkSize),
+	_depth(depth),
+	_size(parentStream->size()),
+	_pos(0),
+	_eos(false),
+	_backgroundPrefetch(false),
+	_current(0),
+	_ready(0),
+	_fillPos(parentStream->pos()),
+	_parentEos(false) {
+
+	assert(chunkSize > 0 && depth >= 2);
+	_buffer = new byte[chunkSize * depth];
+	_chunks = new Chunk[depth];
+	for (uint i = 0; i < depth; i++) {
+		_chunks[i].data = _buffer + i * chunkSize;
+		_chunks[i].offset = _fillPos;
+		_chunks[i].size = 0;
+	}
+}
+
+PrefetchingReadStream::~PrefetchingReadStream() {
+	stopBackgroundPrefetch();
+	delete[] _chunks;
+	delete[] _buffer;
+}
+
+bool PrefetchingReadStream::fillChunk() {
+	// The chunk being read is never refilled
+	if (_parentEos || _ready >= _depth - 1)
+		return false;
+
+	Chunk &chunk = _chunks[(_current + 1 + _ready) % _depth];
+	chunk.offset = _fillPos;
+	chunk.size = _parentStream->read(chunk.data, _chunkSize);
+	_fillPos += chunk.size;
+	// A short read means the end of the stream or an error
+	if (chunk.size < _chunkSize)
+		_parentEos = true;
+	if (chunk.size == 0)
+		return false;
+
+	_ready++;
+	return true;
+}
+
+bool PrefetchingReadStream::nextChunk() {
+	StackLock lock(_mutex);
+
+	if (_ready == 0 && !fillChunk())
+		return false;
+
+	_current = (_current + 1) % _depth;
+	_ready--;
+	_pos = 0;
+	return true;
+}
+
+uint PrefetchingReadStream::prefetch(uint maxChunks) {
+	StackLock lock(_mutex);
+
+	uint chunks = 0;
+	while ((maxChunks == 0 || chunks < maxChunks) && fillChunk())
+		chunks++;
+	return chunks;
+}
+
+void PrefetchingReadStream::startBackgroundPrefetch() {
+	if (!_backgroundPrefetch) {
+		PrefetchScheduler::instance().add(this);
+		_backgroundPrefetch = true;
+	}
+}
+
+void PrefetchingReadStream::stopBackgroundPrefetch() {
+	if (_backgroundPrefetch) {
+		PrefetchScheduler::instance().remove(this);
+		_backgroundPrefetch = false;
+	}
+}
+
+uint32 PrefetchingReadStream::bufferedSize() const {
+	StackLock lock(_mutex);
+
+	uint32 size = _chunks[_current].size - _pos;
+	for (uint i = 1; i <= _ready; i++)
+		size += _chunks[(_current + i) % _depth].size;
+	return size;
+}
+
+bool PrefetchingReadStream::err() const {
+	StackLock lock(_mutex);
+	return _parentStream->err();
+}
+
+void PrefetchingReadStream::clearErr() {
+	StackLock lock(_mutex);
+	_eos = false;
+	_parentEos = false;
+	_parentStream->clearErr();
+}
+
+uint32 PrefetchingReadStream::read(void *dataPtr, uint32 dataSize) {
+	byte *dst = (byte *)dataPtr;
+	uint32 alreadyRead = 0;
+
+	while (dataSize > 0) {
+		const Chunk &chunk = _chunks[_current];
+		if (_pos == chunk.size) {
+			if (!nextChunk()) {
+				_eos = true;
+				break;
+			}
+			continue;
+		}
+
+		const uint32 n = MIN(chunk.size - _pos, dataSize);
+		memcpy(dst, chunk.data + _pos, n);
+		_pos += n;
+		dst += n;
+		dataSize -= n;
+		alreadyRead += n;
+	}
+
+	return alreadyRead;
+}
+
+bool PrefetchingReadStream::seek(int64 offset, int whence) {
+	int64 target;
+	switch (whence) {
+	case SEEK_END:
+		target = _size + offset;
+		break;
+	case SEEK_CUR:
+		target = pos() + offset;
+		break;
+	case SEEK_SET:
+	default:
+		target = offset;
+		break;
+	}
+
+	if (target < 0 || target > _size)
+		return false;
+
+	_eos = false;
+
+	StackLock lock(_mutex);
+
+	// Keep the read ahead data if the target is already in memory
+	for (uint i = 0; i <= _ready; i++) {
+		const uint slot = (_current + i) % _depth;
+		const Chunk &chunk = _chunks[slot];
+		if (target >= chunk.offset && (target < chunk.offset + chunk.size || (i == _ready && target == chunk.offset + chunk.size))) {
+			_current = slot;
+			_ready -= i;
+			_pos = target - chunk.offset;
+			return true;
+		}
+	}
+
+	_ready = 0;
+	_pos = 0;
+	_chunks[_current].offset = target;
+	_chunks[_current].size = 0;
+	_fillPos = target;
+	_parentEos = false;
+	return _parentStream->seek(target);
+}
+
+PrefetchingReadStream *wrapPrefetchingReadStream(SeekableReadStream *parentStream, uint32 chunkSize, uint depth, DisposeAfterUse::Flag disposeParentStream) {
+	if (parentStream)
+		return new PrefetchingReadStream(parentStream, chunkSize, depth, disposeParentStream);
+	return nullptr;
+}
+
+} // End of namespace Common
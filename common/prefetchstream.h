@@ -0,0 +1,156 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COMMON_PREFETCHSTREAM_H
+#define COMMON_PREFETCHSTREAM_H
+
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/stream.h"
+#include "common/types.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_prefetchstream Prefetching stream
+ * @ingroup common
+ *
+ * @brief  API for reading ahead of a sequential consumer.
+ *
+ * @{
+ */
+
+/**
+ * Wrapper around any SeekableReadStream which keeps a ring of chunks read
+ * ahead of the current position.
+ *
+ * The consumer is served from the current chunk, and only has to wait for
+ * the parent stream when no prefetched chunk is left. The free chunks are
+ * filled by prefetch(). After startBackgroundPrefetch() this is done by a
+ * timer callback, so the reading thread doesn't spend any time on it. The
+ * chunk ring and the parent stream are guarded by a mutex for this.
+ *
+ * Seeks into the current or a prefetched chunk keep the read ahead data,
+ * other seeks discard it.
+ */
+class PrefetchingReadStream : public SeekableReadStream {
+public:
+	/**
+	 * @param parentStream        The stream to read ahead from.
+	 * @param chunkSize           Size of a single read from the parent stream.
+	 * @param depth               Number of chunks, including the one being read. Must be at least 2.
+	 * @param disposeParentStream Flag indicating whether to dispose of the wrapped stream.
+	 */
+	PrefetchingReadStream(SeekableReadStream *parentStream, uint32 chunkSize, uint depth, DisposeAfterUse::Flag disposeParentStream);
+	~PrefetchingReadStream() override;
+
+	/**
+	 * Read up to maxChunks chunks ahead of the current one, or fill all free
+	 * chunks if maxChunks is 0.
+	 *
+	 * @return The number of chunks read from the parent stream.
+	 */
+	uint prefetch(uint maxChunks = 0);
+
+	/**
+	 * Fill the free chunks from a timer callback until
+	 * stopBackgroundPrefetch() is called or the stream is destroyed.
+	 *
+	 * The parent stream must not depend on state which is only safe to use
+	 * from the main thread.
+	 */
+	void startBackgroundPrefetch();
+
+	/**
+	 * Stop filling chunks from the timer callback. When this returns, the
+	 * callback no longer touches the stream.
+	 */
+	void stopBackgroundPrefetch();
+
+	/**
+	 * Return the number of bytes which can be read without waiting for the
+	 * parent stream.
+	 */
+	uint32 bufferedSize() const;
+
+	bool eos() const override { return _eos; }
+	bool err() const override;
+	void clearErr() override;
+
+	uint32 read(void *dataPtr, uint32 dataSize) override;
+
+	int64 pos() const override { return _chunks[_current].offset + _pos; }
+	int64 size() const override { return _size; }
+	bool seek(int64 offset, int whence = SEEK_SET) override;
+
+private:
+	struct Chunk {
+		byte *data;
+		int64 offset; // position of data in the parent stream
+		uint32 size;
+	};
+
+	DisposablePtr<SeekableReadStream> _parentStream;
+	Mutex _mutex;
+	byte *_buffer;
+	Chunk *_chunks;
+	const uint32 _chunkSize;
+	const uint _depth;
+	const int64 _size;
+
+	// Only touched by the consumer
+	uint32 _pos;
+	bool _eos;
+	bool _backgroundPrefetch;
+
+	// Held by the timer callback while it fills this stream
+	friend class PrefetchScheduler;
+	Mutex _callbackMutex;
+
+	// Guarded by _mutex, the consumer may read _current without it
+	uint _current;
+	uint _ready; // prefetched chunks following _current
+	int64 _fillPos;
+	bool _parentEos;
+
+	bool fillChunk();
+	bool nextChunk();
+};
+
+/**
+ * Take an arbitrary SeekableReadStream and wrap it in a PrefetchingReadStream.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ *
+ * @param parentStream        The SeekableReadStream to wrap.
+ * @param chunkSize           Size of a single read from the parent stream.
+ * @param depth               Number of chunks, including the one being read.
+ * @param disposeParentStream Flag indicating whether to dispose of the wrapped stream.
+ */
+PrefetchingReadStream *wrapPrefetchingReadStream(SeekableReadStream *parentStream, uint32 chunkSize, uint depth, DisposeAfterUse::Flag disposeParentStream);
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
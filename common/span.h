@@ -994,6 +994,29 @@ public:
 	inline reference operator[](const index_type index) { return _span[index]; }
 };
 
+#pragma mark -
+#pragma mark MemoryReadStream
+
+/**
+ * Return a view of the next dataSize bytes of the stream's buffer and skip
+ * them, without copying. The view is bounds checked, and stays valid as long
+ * as the buffer does.
+ *
+ * If fewer bytes are left, the position is not changed, eos is set and an
+ * empty span is returned.
+ */
+inline Span<const byte> readSpan(MemoryReadStream &stream, uint32 dataSize) {
+	if (dataSize > stream._size - stream._pos) {
+		stream._eos = true;
+		return Span<const byte>();
+	}
+
+	Span<const byte> span(stream._ptr, dataSize);
+	stream._ptr += dataSize;
+	stream._pos += dataSize;
+	return span;
+}
+
 } // End of namespace Common
 
 #endif
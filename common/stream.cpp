@@ -136,6 +136,67 @@ bool MemoryReadStream::seek(int64 offs, int whence) {
 	return true; // FIXME: STREAM REWRITE
 }
 
+uint32 MemoryReadStream::beginArrayRead(uint32 count, uint32 valueSize) {
+	const uint32 available = (_size - _pos) / valueSize;
+	if (count > available) {
+		count = available;
+		_eos = true;
+	}
+	return count;
+}
+
+uint32 MemoryReadStream::readUint16LEArray(uint16 *dst, uint32 count) {
+	count = beginArrayRead(count, sizeof(uint16));
+#ifdef SCUMM_LITTLE_ENDIAN
+	memcpy(dst, _ptr, count * sizeof(uint16));
+#else
+	for (uint32 i = 0; i < count; i++)
+		dst[i] = READ_LE_UINT16(_ptr + i * sizeof(uint16));
+#endif
+	_ptr += count * sizeof(uint16);
+	_pos += count * sizeof(uint16);
+	return count;
+}
+
+uint32 MemoryReadStream::readUint16BEArray(uint16 *dst, uint32 count) {
+	count = beginArrayRead(count, sizeof(uint16));
+#ifdef SCUMM_BIG_ENDIAN
+	memcpy(dst, _ptr, count * sizeof(uint16));
+#else
+	for (uint32 i = 0; i < count; i++)
+		dst[i] = READ_BE_UINT16(_ptr + i * sizeof(uint16));
+#endif
+	_ptr += count * sizeof(uint16);
+	_pos += count * sizeof(uint16);
+	return count;
+}
+
+uint32 MemoryReadStream::readUint32LEArray(uint32 *dst, uint32 count) {
+	count = beginArrayRead(count, sizeof(uint32));
+#ifdef SCUMM_LITTLE_ENDIAN
+	memcpy(dst, _ptr, count * sizeof(uint32));
+#else
+	for (uint32 i = 0; i < count; i++)
+		dst[i] = READ_LE_UINT32(_ptr + i * sizeof(uint32));
+#endif
+	_ptr += count * sizeof(uint32);
+	_pos += count * sizeof(uint32);
+	return count;
+}
+
+uint32 MemoryReadStream::readUint32BEArray(uint32 *dst, uint32 count) {
+	count = beginArrayRead(count, sizeof(uint32));
+#ifdef SCUMM_BIG_ENDIAN
+	memcpy(dst, _ptr, count * sizeof(uint32));
+#else
+	for (uint32 i = 0; i < count; i++)
+		dst[i] = READ_BE_UINT32(_ptr + i * sizeof(uint32));
+#endif
+	_ptr += count * sizeof(uint32);
+	_pos += count * sizeof(uint32);
+	return count;
+}
+
 #pragma mark -
 
 enum {
@@ -1390,6 +1390,14 @@ public:
 	 */
 	virtual uint32 getMillis(bool skipRecord = false) = 0;
 
+	/**
+	 * Get a timestamp in microseconds, for profiling. Only differences
+	 * between two values are meaningful. The value is not recorded by the
+	 * event recorder, and backends without a finer timer fall back to
+	 * millisecond resolution.
+	 */
+	virtual uint64 getMicros() { return (uint64)getMillis(true) * 1000; }
+
 	/** Delay/sleep for the specified amount of milliseconds. */
 	virtual void delayMillis(uint msecs) = 0;
 
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+# Converts the PNG images of a Neverhood loose data pack to QOI.
+#
+# The engine probes for <hash>.qoi before <hash>.png in <looseDataFolder>/images,
+# so the converted files can be dropped next to (or instead of) the PNG files.
+#
+# Usage: neverhood-png2qoi.py <images folder> [--delete]
+#
+# Only non-interlaced 8-bit RGB, RGBA and paletted PNG files are supported,
+# which covers the output of the usual upscaling tools.
+import os, struct, sys, zlib
+
+PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+
+def paeth(a, b, c):
+	p = a + b - c
+	pa = abs(p - a)
+	pb = abs(p - b)
+	pc = abs(p - c)
+	if pa <= pb and pa <= pc:
+		return a
+	if pb <= pc:
+		return b
+	return c
+
+def readPNG(filename):
+	"""Returns (width, height, rgba bytes) of a PNG file"""
+	with open(filename, 'rb') as f:
+		data = f.read()
+	if data[:8] != PNG_SIGNATURE:
+		raise ValueError('not a PNG file')
+	pos = 8
+	idat = []
+	palette = None
+	trns = None
+	while pos < len(data):
+		length, tag = struct.unpack('>I4s', data[pos:pos + 8])
+		chunk = data[pos + 8:pos + 8 + length]
+		pos += 12 + length
+		if tag == b'IHDR':
+			width, height, bitDepth, colorType, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+		elif tag == b'PLTE':
+			palette = chunk
+		elif tag == b'tRNS':
+			trns = chunk
+		elif tag == b'IDAT':
+			idat.append(chunk)
+		elif tag == b'IEND':
+			break
+	if bitDepth != 8 or interlace != 0 or colorType not in (2, 3, 6):
+		raise ValueError('unsupported PNG format (depth %d, type %d, interlace %d)' % (bitDepth, colorType, interlace))
+	bpp = { 2: 3, 3: 1, 6: 4 }[colorType]
+	raw = zlib.decompress(b''.join(idat))
+	stride = width * bpp
+	prev = bytearray(stride)
+	rgba = bytearray(width * height * 4)
+	for y in range(height):
+		filterType = raw[y * (stride + 1)]
+		line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+		for x in range(stride):
+			a = line[x - bpp] if x >= bpp else 0
+			b = prev[x]
+			c = prev[x - bpp] if x >= bpp else 0
+			if filterType == 1:
+				line[x] = (line[x] + a) & 0xFF
+			elif filterType == 2:
+				line[x] = (line[x] + b) & 0xFF
+			elif filterType == 3:
+				line[x] = (line[x] + ((a + b) >> 1)) & 0xFF
+			elif filterType == 4:
+				line[x] = (line[x] + paeth(a, b, c)) & 0xFF
+		dst = y * width * 4
+		for x in range(width):
+			if colorType == 6:
+				rgba[dst:dst + 4] = line[x * 4:x * 4 + 4]
+			elif colorType == 2:
+				rgba[dst:dst + 3] = line[x * 3:x * 3 + 3]
+				rgba[dst + 3] = 0xFF
+			else:
+				index = line[x]
+				rgba[dst:dst + 3] = palette[index * 3:index * 3 + 3]
+				rgba[dst + 3] = trns[index] if trns and index < len(trns) else 0xFF
+			dst += 4
+		prev = line
+	return width, height, rgba
+
+def writeQOI(filename, width, height, rgba):
+	out = bytearray(struct.pack('>4sIIBB', b'qoif', width, height, 4, 0))
+	index = [(0, 0, 0, 0)] * 64
+	prev = (0, 0, 0, 255)
+	run = 0
+	for i in range(0, len(rgba), 4):
+		px = tuple(rgba[i:i + 4])
+		if px == prev:
+			run += 1
+			if run == 62:
+				out.append(0xC0 | (run - 1))
+				run = 0
+			continue
+		if run > 0:
+			out.append(0xC0 | (run - 1))
+			run = 0
+		hashIndex = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64
+		if index[hashIndex] == px:
+			out.append(hashIndex)
+		else:
+			index[hashIndex] = px
+			if px[3] == prev[3]:
+				vr = ((px[0] - prev[0] + 128) & 0xFF) - 128
+				vg = ((px[1] - prev[1] + 128) & 0xFF) - 128
+				vb = ((px[2] - prev[2] + 128) & 0xFF) - 128
+				vgr = vr - vg
+				vgb = vb - vg
+				if -3 < vr < 2 and -3 < vg < 2 and -3 < vb < 2:
+					out.append(0x40 | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2))
+				elif -9 < vgr < 8 and -33 < vg < 32 and -9 < vgb < 8:
+					out.append(0x80 | (vg + 32))
+					out.append(((vgr + 8) << 4) | (vgb + 8))
+				else:
+					out += bytes((0xFE, px[0], px[1], px[2]))
+			else:
+				out += bytes((0xFF, px[0], px[1], px[2], px[3]))
+		prev = px
+	if run > 0:
+		out.append(0xC0 | (run - 1))
+	out += b'\x00' * 7 + b'\x01'
+	with open(filename, 'wb') as f:
+		f.write(out)
+
+def main():
+	if len(sys.argv) < 2:
+		print('Usage: %s <images folder> [--delete]' % sys.argv[0])
+		sys.exit(1)
+	folder = sys.argv[1]
+	deletePNG = '--delete' in sys.argv[2:]
+	for name in sorted(os.listdir(folder)):
+		base, ext = os.path.splitext(name)
+		if ext.lower() != '.png':
+			continue
+		pngName = os.path.join(folder, name)
+		try:
+			width, height, rgba = readPNG(pngName)
+		except ValueError as e:
+			print('%s: %s, skipped' % (name, e))
+			continue
+		writeQOI(os.path.join(folder, base + '.qoi'), width, height, rgba)
+		print('%s -> %s.qoi' % (name, base))
+		if deletePNG:
+			os.remove(pngName)
+
+if __name__ == '__main__':
+	main()
@@ -504,6 +504,62 @@ namespace Common {
 	DECLARE_SINGLETON(MD5CacheManager);
 }
 
+bool MD5CacheManager::isPersistentCacheEnabled() const {
+	return ConfMan.getBool("md5_cache");
+}
+
+Common::FSNode MD5CacheManager::getPersistentCacheFile() const {
+	// The cache is kept next to the configuration file
+	Common::String configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+	return Common::FSNode(configFile).getParent().getChild("md5cache.dat");
+}
+
+void MD5CacheManager::loadPersistentCache() {
+	persistentLoaded = true;
+	if (!isPersistentCacheEnabled())
+		return;
+
+	Common::FSNode file = getPersistentCacheFile();
+	if (!file.exists())
+		return;
+	Common::SeekableReadStream *stream = file.createReadStream();
+	if (!stream)
+		return;
+	persistentCache.load(*stream);
+	delete stream;
+}
+
+bool MD5CacheManager::getPersistentMD5(const Common::String &key, int64 size, int64 modificationTime, Common::String &md5) {
+	if (!persistentLoaded)
+		loadPersistentCache();
+	return persistentCache.get(key, size, modificationTime, md5);
+}
+
+void MD5CacheManager::setPersistentMD5(const Common::String &key, int64 size, int64 modificationTime, const Common::String &md5) {
+	if (!persistentLoaded)
+		loadPersistentCache();
+	persistentCache.set(key, size, modificationTime, md5);
+}
+
+void MD5CacheManager::savePersistentCache() {
+	if (!persistentCache.isDirty() || !isPersistentCacheEnabled())
+		return;
+	persistentCache.clearDirty();
+
+	Common::FSNode file = getPersistentCacheFile();
+	Common::WriteStream *stream = file.createWriteStream();
+	if (!stream) {
+		warning("Unable to write the MD5 cache '%s'", file.getPath().c_str());
+		return;
+	}
+
+	persistentCache.save(*stream);
+	stream->finalize();
+	delete stream;
+}
+
 // Sync with engines/game.cpp
 static char flagsToMD5Prefix(uint32 flags) {
 	if (flags & ADGF_MACRESFORK) {
@@ -528,11 +584,30 @@ bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, con
 		return true;
 	}
 
+	// Plain files are looked up in the persistent cache as well, which only
+	// costs getting their size and modification time. Resource forks are
+	// left out, since they may come from other files than the named one.
+	Common::String persistentName;
+	int64 size = 0, modificationTime = 0;
+	if (!(game.flags & ADGF_MACRESFORK) && allFiles.contains(fname) &&
+		allFiles[fname].getFileStat(size, modificationTime)) {
+		persistentName = Common::String::format("%c:%d:%s", flagsToMD5Prefix(game.flags), _md5Bytes, allFiles[fname].getPath().c_str());
+
+		if (MD5Man.getPersistentMD5(persistentName, size, modificationTime, fileProps.md5)) {
+			fileProps.size = size;
+			MD5Man.setMD5(hashname, fileProps.md5);
+			MD5Man.setSize(hashname, fileProps.size);
+			return true;
+		}
+	}
+
 	bool res = getFilePropertiesIntern(_md5Bytes, allFiles, game, fname, fileProps);
 
 	if (res) {
 		MD5Man.setMD5(hashname, fileProps.md5);
 		MD5Man.setSize(hashname, fileProps.size);
+		if (!persistentName.empty())
+			MD5Man.setPersistentMD5(persistentName, size, modificationTime, fileProps.md5);
 	}
 
 	return res;
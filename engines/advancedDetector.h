@@ -24,6 +24,7 @@
 
 #include "engines/metaengine.h"
 #include "engines/engine.h"
+#include "engines/md5cache.h"
 
 #include "common/hash-str.h"
 
@@ -557,22 +558,44 @@ public:
 		return (md5HashMap.contains(fname) && sizeHashMap.contains(fname));
 	}
 
-	MD5CacheManager() {
+	MD5CacheManager() : persistentLoaded(false) {
 		clear();
 	}
 
+	/**
+	 * Clear the cache of the current detection pass. The persistent cache
+	 * is kept.
+	 */
 	void clear() {
 		md5HashMap.clear(true);
 		sizeHashMap.clear(true);
 	}
 
+	/**
+	 * Look up a file in the persistent cache, which is kept on disk between
+	 * sessions, see PersistentMD5Cache.
+	 *
+	 * The cache file is loaded on the first call.
+	 */
+	bool getPersistentMD5(const Common::String &key, int64 size, int64 modificationTime, Common::String &md5);
+	void setPersistentMD5(const Common::String &key, int64 size, int64 modificationTime, const Common::String &md5);
+
+	/** Write the persistent cache to disk, if it changed. */
+	void savePersistentCache();
+
 private:
 	friend class Common::Singleton<MD5CacheManager>;
 
+	bool isPersistentCacheEnabled() const;
+	Common::FSNode getPersistentCacheFile() const;
+	void loadPersistentCache();
+
 	typedef Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileHashMap;
 	typedef Common::HashMap<Common::String, int64, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SizeHashMap;
 	FileHashMap md5HashMap;
 	SizeHashMap sizeHashMap;
+	PersistentMD5Cache persistentCache;
+	bool persistentLoaded;
 };
 
 /** Convenience shortcut for accessing the MD5CacheManager. */
@@ -0,0 +1,115 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/stream.h"
+#include "common/util.h"
+#include "engines/md5cache.h"
+
+// Version 2 keeps the modification time with sub-second precision where the
+// file system has it
+static const char *const md5CacheHeader = "# ScummVM MD5 cache 2";
+
+// Split off the next tab separated field of a cache line
+static bool nextMD5CacheField(const char *&line, Common::String &field) {
+	const char *end = strchr(line, '\t');
+	if (!end)
+		return false;
+	field = Common::String(line, end);
+	line = end + 1;
+	return true;
+}
+
+static bool parseMD5CacheInt(const Common::String &field, int64 &value) {
+	const char *str = field.c_str();
+	bool negative = (*str == '-');
+	if (negative)
+		str++;
+	if (!*str)
+		return false;
+
+	value = 0;
+	for (; *str; str++) {
+		if (!Common::isDigit(*str))
+			return false;
+		value = value * 10 + (*str - '0');
+	}
+	if (negative)
+		value = -value;
+	return true;
+}
+
+bool PersistentMD5Cache::load(Common::SeekableReadStream &stream) {
+	// Caches of other versions are simply rebuilt
+	if (stream.readLine() != md5CacheHeader)
+		return false;
+
+	// The key comes last, since it contains the path
+	while (!stream.eos() && !stream.err()) {
+		Common::String line = stream.readLine();
+		const char *str = line.c_str();
+		Common::String md5, size, modificationTime;
+		Entry entry;
+		if (!nextMD5CacheField(str, md5) || !nextMD5CacheField(str, size) || !nextMD5CacheField(str, modificationTime) ||
+			!parseMD5CacheInt(size, entry.size) || !parseMD5CacheInt(modificationTime, entry.modificationTime) || !*str)
+			continue;
+
+		entry.md5 = md5;
+		entry.used = false;
+		_entries.setVal(str, entry);
+	}
+
+	return true;
+}
+
+void PersistentMD5Cache::save(Common::WriteStream &stream) const {
+	const bool prune = _entries.size() > kMaxEntries;
+	stream.writeString(md5CacheHeader);
+	stream.writeByte('\n');
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		if (prune && !i->_value.used)
+			continue;
+		stream.writeString(Common::String::format("%s\t%lld\t%lld\t%s\n", i->_value.md5.c_str(),
+			(long long)i->_value.size, (long long)i->_value.modificationTime, i->_key.c_str()));
+	}
+}
+
+bool PersistentMD5Cache::get(const Common::String &key, int64 size, int64 modificationTime, Common::String &md5) {
+	EntryMap::iterator i = _entries.find(key);
+	if (i == _entries.end() || i->_value.size != size || i->_value.modificationTime != modificationTime)
+		return false;
+
+	i->_value.used = true;
+	md5 = i->_value.md5;
+	return true;
+}
+
+void PersistentMD5Cache::set(const Common::String &key, int64 size, int64 modificationTime, const Common::String &md5) {
+	// Such a key would break the line based file
+	if (key.contains('\n') || key.contains('\r'))
+		return;
+
+	Entry &entry = _entries.getOrCreateVal(key);
+	entry.size = size;
+	entry.modificationTime = modificationTime;
+	entry.md5 = md5;
+	entry.used = true;
+	_dirty = true;
+}
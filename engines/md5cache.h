@@ -0,0 +1,86 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ENGINES_MD5CACHE_H
+#define ENGINES_MD5CACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+
+namespace Common {
+class SeekableReadStream;
+class WriteStream;
+}
+
+/**
+ * The detection MD5s kept on disk between sessions, in md5cache.dat. Entries
+ * are keyed by the full path of the file, and are only used while the file
+ * keeps its size and modification time.
+ *
+ * The file has a header line, followed by one line per entry, which is
+ * "md5 size modification-time key", separated by tabs.
+ */
+class PersistentMD5Cache {
+public:
+	PersistentMD5Cache() : _dirty(false) {}
+
+	/**
+	 * Add the entries of a cache file. Lines which cannot be parsed are
+	 * skipped.
+	 *
+	 * @return False if the stream is no cache file of this version.
+	 */
+	bool load(Common::SeekableReadStream &stream);
+
+	/**
+	 * Write all entries as a cache file. Once there are more than
+	 * kMaxEntries, the entries which were not used in this session are left
+	 * out, so files which are gone do not pile up forever.
+	 */
+	void save(Common::WriteStream &stream) const;
+
+	bool get(const Common::String &key, int64 size, int64 modificationTime, Common::String &md5);
+	void set(const Common::String &key, int64 size, int64 modificationTime, const Common::String &md5);
+
+	/** Whether entries were set since the last clearDirty(). */
+	bool isDirty() const { return _dirty; }
+	void clearDirty() { _dirty = false; }
+
+	uint size() const { return _entries.size(); }
+
+	static const uint kMaxEntries = 10000;
+
+private:
+	struct Entry {
+		int64 size;
+		int64 modificationTime;
+		Common::String md5;
+		bool used;	///< Looked up or added in this session
+	};
+
+	// Paths may differ only in case on some file systems
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+	EntryMap _entries;
+	bool _dirty;
+};
+
+#endif
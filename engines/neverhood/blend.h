@@ -0,0 +1,156 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NEVERHOOD_BLEND_H
+#define NEVERHOOD_BLEND_H
+
+#include "common/scummsys.h"
+#include "graphics/surface.h"
+#include "neverhood/simd.h"
+
+namespace Neverhood {
+
+inline int getAlphaOffset(int pos, int bytes_per_pixel) {
+	return (pos & 0xFFFFFFFC) + bytes_per_pixel - 1;
+}
+
+inline byte clampByte(int16 val) {
+	return (byte)((val < 0) ? 0 : (val > 255) ? 255
+											  : val);
+}
+
+inline void blendColor(byte *dst, const byte *src, int bytes_per_pixel, const Graphics::RgbOffset* rgb_offset) {
+	int16 min = 0;
+	int16 max = 255;
+	int16 width = max - min;
+
+	byte src_pixel[4];
+	memcpy(src_pixel, src, bytes_per_pixel);
+
+	if (rgb_offset) {
+		rgb_offset->applyTo(&src_pixel[0]);
+	}
+
+	int16 dst_alpha = dst[getAlphaOffset(0, bytes_per_pixel)];
+
+	if (dst_alpha == 0) {
+		memcpy(dst, src_pixel, bytes_per_pixel);
+		return;
+	}
+
+	int16 src_alpha = src_pixel[getAlphaOffset(0, bytes_per_pixel)];
+	if (src_alpha >= max) {
+		memcpy(dst, src_pixel, bytes_per_pixel);
+	} else if (src_alpha >= min) {
+		float falpha = (src_alpha - min) / (float)width;
+		for (int i = 0; i < bytes_per_pixel; ++i) {
+			dst[i] = clampByte(src_pixel[i] * falpha + dst[i] * (1.f - falpha));
+		}
+	}
+}
+
+/**
+ * Blends a row of 32bpp shadow pixels onto dst wherever the matching mask
+ * pixel has a non-zero alpha. This is the reference implementation.
+ */
+inline void blendShadowSpanScalar(byte *dst, const byte *mask, const byte *shadow, int width, const Graphics::RgbOffset *rgbOffset) {
+	for (int xc = 0; xc < width * 4; xc += 4) {
+		if (mask[getAlphaOffset(xc, 4)] > 0)
+			blendColor(dst + xc, shadow + xc, 4, rgbOffset);
+	}
+}
+
+#ifdef NEVERHOOD_SSE2
+
+// Lerps one pixel per vector, the same float operations as blendColor()
+inline __m128i blendShadowLerp(__m128i src16, __m128i dst16, __m128 srcWeight, __m128 dstWeight) {
+	const __m128 src = _mm_cvtepi32_ps(src16);
+	const __m128 dst = _mm_cvtepi32_ps(dst16);
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(src, srcWeight), _mm_mul_ps(dst, dstWeight)));
+}
+
+inline __m128i blendShadowApplyOffset(__m128i src16, __m128i offset, __m128i zero, __m128i maxChannel) {
+	return _mm_min_epi16(_mm_max_epi16(_mm_adds_epi16(src16, offset), zero), maxChannel);
+}
+
+#endif
+
+/**
+ * Same as blendShadowSpanScalar() but handles four pixels at a time where
+ * SSE2 is available. Groups of pixels where the mask is fully transparent are
+ * skipped without touching the shadow or the destination.
+ */
+inline void blendShadowSpan(byte *dst, const byte *mask, const byte *shadow, int width, const Graphics::RgbOffset *rgbOffset) {
+#ifdef NEVERHOOD_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+	const __m128i opaqueAlpha = _mm_set1_epi32(255);
+	const __m128i maxChannel = _mm_set1_epi16(255);
+	const __m128 alphaScale = _mm_set1_ps(255.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128i offset = rgbOffset ? _mm_setr_epi16(rgbOffset->offset[0], rgbOffset->offset[1], rgbOffset->offset[2], 0,
+		rgbOffset->offset[0], rgbOffset->offset[1], rgbOffset->offset[2], 0) : zero;
+
+	for (; width >= 4; width -= 4, dst += 16, mask += 16, shadow += 16) {
+		const __m128i maskClear = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i *)mask), alphaMask), zero);
+		if (_mm_movemask_epi8(maskClear) == 0xFFFF)
+			continue;
+
+		const __m128i dstPixels = _mm_loadu_si128((const __m128i *)dst);
+		__m128i src = _mm_loadu_si128((const __m128i *)shadow);
+		__m128i srcLo = _mm_unpacklo_epi8(src, zero);
+		__m128i srcHi = _mm_unpackhi_epi8(src, zero);
+		if (rgbOffset) {
+			srcLo = blendShadowApplyOffset(srcLo, offset, zero, maxChannel);
+			srcHi = blendShadowApplyOffset(srcHi, offset, zero, maxChannel);
+			src = _mm_packus_epi16(srcLo, srcHi);
+		}
+		const __m128i dstLo = _mm_unpacklo_epi8(dstPixels, zero);
+		const __m128i dstHi = _mm_unpackhi_epi8(dstPixels, zero);
+
+		const __m128i srcAlpha = _mm_srli_epi32(src, 24);
+		const __m128i copySrc = _mm_or_si128(_mm_cmpeq_epi32(_mm_srli_epi32(dstPixels, 24), zero),
+			_mm_cmpeq_epi32(srcAlpha, opaqueAlpha));
+
+		const __m128 srcWeight = _mm_div_ps(_mm_cvtepi32_ps(srcAlpha), alphaScale);
+		const __m128 dstWeight = _mm_sub_ps(one, srcWeight);
+
+		const __m128i p0 = blendShadowLerp(_mm_unpacklo_epi16(srcLo, zero), _mm_unpacklo_epi16(dstLo, zero),
+			_mm_shuffle_ps(srcWeight, srcWeight, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(dstWeight, dstWeight, _MM_SHUFFLE(0, 0, 0, 0)));
+		const __m128i p1 = blendShadowLerp(_mm_unpackhi_epi16(srcLo, zero), _mm_unpackhi_epi16(dstLo, zero),
+			_mm_shuffle_ps(srcWeight, srcWeight, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(dstWeight, dstWeight, _MM_SHUFFLE(1, 1, 1, 1)));
+		const __m128i p2 = blendShadowLerp(_mm_unpacklo_epi16(srcHi, zero), _mm_unpacklo_epi16(dstHi, zero),
+			_mm_shuffle_ps(srcWeight, srcWeight, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(dstWeight, dstWeight, _MM_SHUFFLE(2, 2, 2, 2)));
+		const __m128i p3 = blendShadowLerp(_mm_unpackhi_epi16(srcHi, zero), _mm_unpackhi_epi16(dstHi, zero),
+			_mm_shuffle_ps(srcWeight, srcWeight, _MM_SHUFFLE(3, 3, 3, 3)), _mm_shuffle_ps(dstWeight, dstWeight, _MM_SHUFFLE(3, 3, 3, 3)));
+		const __m128i blended = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+
+		__m128i result = _mm_or_si128(_mm_and_si128(copySrc, src), _mm_andnot_si128(copySrc, blended));
+		result = _mm_or_si128(_mm_and_si128(maskClear, dstPixels), _mm_andnot_si128(maskClear, result));
+		_mm_storeu_si128((__m128i *)dst, result);
+	}
+#endif
+	blendShadowSpanScalar(dst, mask, shadow, width, rgbOffset);
+}
+
+} // End of namespace Neverhood
+
+#endif /* NEVERHOOD_BLEND_H */
@@ -21,10 +21,16 @@
 
 #include "neverhood/console.h"
 #include "gui/debugger.h"
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "audio/decoders/raw.h"
 #include "neverhood/neverhood.h"
 #include "neverhood/gamemodule.h"
 #include "neverhood/navigationscene.h"
+#include "neverhood/resourceman.h"
 #include "neverhood/scene.h"
+#include "neverhood/screen.h"
 #include "neverhood/smackerscene.h"
 #include "neverhood/sound.h"
 #include "neverhood/modules/module1600.h"
@@ -40,6 +46,11 @@ Console::Console(NeverhoodEngine *vm) : GUI::Debugger(), _vm(vm) {
 	registerCmd("playsound",		WRAP_METHOD(Console, Cmd_PlaySound));
 	registerCmd("scene",			WRAP_METHOD(Console, Cmd_Scene));
 	registerCmd("surfaces",		WRAP_METHOD(Console, Cmd_Surfaces));
+	registerCmd("video",			WRAP_METHOD(Console, Cmd_Video));
+	registerCmd("surfacepool",	WRAP_METHOD(Console, Cmd_SurfacePool));
+	registerCmd("resampler",		WRAP_METHOD(Console, Cmd_Resampler));
+	registerCmd("mixer",			WRAP_METHOD(Console, Cmd_Mixer));
+	registerCmd("decompress",	WRAP_METHOD(Console, Cmd_Decompress));
 	registerCmd("dump", WRAP_METHOD(Console, Cmd_Dump));
 }
 
@@ -100,6 +111,184 @@ bool Console::Cmd_Surfaces(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::Cmd_Video(int argc, const char **argv) {
+	SmackerPlayer *smackerPlayer = nullptr;
+	if (_vm->_gameModule->_childObject && ((GameModule *)_vm->_gameModule->_childObject)->_childObject)
+		smackerPlayer = ((Scene *)((GameModule *)_vm->_gameModule->_childObject)->_childObject)->getSmackerPlayer();
+
+	if (!smackerPlayer || !smackerPlayer->getSmackerDecoder()) {
+		debugPrintf("No video is playing\n");
+		return true;
+	}
+
+	const SmackerPlayer::PresentationStats &stats = smackerPlayer->getPresentationStats();
+	debugPrintf("File hash: 0x%x, frame %u of %u\n", smackerPlayer->getFileHash(),
+		smackerPlayer->getFrameNumber() + 1, smackerPlayer->getFrameCount());
+	debugPrintf("Presented: %u, dropped: %u, late: %u, max A/V drift: %d ms\n",
+		stats.presentedFrames, stats.droppedFrames, stats.lateFrames, stats.maxDrift);
+	return true;
+}
+
+bool Console::Cmd_SurfacePool(int argc, const char **argv) {
+	SurfacePool *surfacePool = _vm->_screen->getSurfacePool();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "purge")) {
+		surfacePool->purge();
+		debugPrintf("Surface pool purged\n");
+	} else if (argc != 1) {
+		debugPrintf("Usage: %s [purge]\n", argv[0]);
+		return true;
+	}
+
+	const SurfacePool::Stats &stats = surfacePool->getStats();
+	debugPrintf("Requests: %u, reused: %u, released: %u, discarded: %u\n",
+		stats.requests, stats.reused, stats.released, stats.discarded);
+	debugPrintf("In use: %u KB (peak %u KB), pooled: %u KB\n",
+		stats.bytesInUse / 1024, stats.peakBytesInUse / 1024, stats.bytesPooled / 1024);
+	return true;
+}
+
+bool Console::Cmd_Resampler(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Usage: %s [seconds]\n", argv[0]);
+		return true;
+	}
+
+	// The game's own audio is 22050 Hz mono
+	const uint inRate = 22050;
+	const uint outRate = _vm->_mixer->getOutputRate();
+	const int seconds = argc == 2 ? MAX(atoi(argv[1]), 1) : 10;
+	static const char *const qualityNames[] = { "low", "medium", "high" };
+
+	const int inSamples = inRate;
+	int16 *noise = (int16 *)malloc(inSamples * sizeof(int16));
+	uint32 seed = 1;
+	for (int i = 0; i < inSamples; i++) {
+		seed = seed * 1103515245 + 12345;
+		noise[i] = (int16)(seed >> 16) / 4;
+	}
+	Audio::RewindableAudioStream *source = Audio::makeRawStream((byte *)noise, inSamples * sizeof(int16), inRate,
+		Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+	Audio::AudioStream *input = Audio::makeLoopingAudioStream(source, 0);
+
+	debugPrintf("Resampling %d seconds of %d Hz mono audio to %d Hz, one channel:\n", seconds, inRate, outRate);
+
+	int32 bus[1024 * 2];
+	for (int quality = Audio::kRateQualityLow; quality <= Audio::kRateQualityHigh; quality++) {
+		Audio::SincFilter *filter = nullptr;
+		if (quality != Audio::kRateQualityLow) {
+			if (!Audio::SincFilter::isSupported(inRate, outRate)) {
+				debugPrintf("  %-6s not supported for this output rate\n", qualityNames[quality]);
+				continue;
+			}
+			filter = new Audio::SincFilter(inRate, outRate, (Audio::RateConverterQuality)quality);
+		}
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, false, false, filter);
+
+		const uint32 startTime = _vm->_system->getMillis();
+		for (uint frames = 0; frames < outRate * seconds; frames += 1024)
+			converter->flow(*input, bus, 1024, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		const uint32 elapsed = _vm->_system->getMillis() - startTime;
+
+		// One millisecond per second of audio is a tenth of a percent of one core
+		debugPrintf("  %-6s %5d ms, %d.%02d%% of one core\n", qualityNames[quality], elapsed,
+			elapsed / seconds / 10, (elapsed * 10 / seconds) % 100);
+
+		delete converter;
+		delete filter;
+	}
+
+	delete input;
+	return true;
+}
+
+bool Console::Cmd_Decompress(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Usage: %s [passes]\n", argv[0]);
+		return true;
+	}
+
+	const int passes = argc == 2 ? MAX(atoi(argv[1]), 1) : 1;
+	uint entryCount = 0;
+	uint32 packedSize = 0, unpackedSize = 0;
+	uint64 elapsed = 0;
+
+	// Reading the packed data is timed as well, but after the first pass it
+	// comes from the file cache
+	for (uint archiveIndex = 0; archiveIndex < _vm->_res->getArchiveCount(); archiveIndex++) {
+		BlbArchive *archive = _vm->_res->getArchive(archiveIndex);
+		for (uint i = 0; i < archive->getCount(); i++) {
+			BlbArchiveEntry *entry = archive->getEntry(i);
+			if (entry->comprType != 3)
+				continue;
+
+			byte *buffer = (byte *)malloc(entry->size);
+			const uint64 startTime = _vm->_system->getMicros();
+			for (int pass = 0; pass < passes; pass++)
+				archive->load(entry, buffer, entry->size);
+			elapsed += _vm->_system->getMicros() - startTime;
+			free(buffer);
+
+			entryCount++;
+			packedSize += entry->diskSize;
+			unpackedSize += entry->size;
+		}
+	}
+
+	const uint32 ms = MAX<uint32>(elapsed / 1000, 1);
+	debugPrintf("Unpacked %d DCL entries %d times, %d KB from %d KB\n", entryCount, passes,
+		unpackedSize / 1024, packedSize / 1024);
+	debugPrintf("%d ms, %d KB/s unpacked\n", (int)(elapsed / 1000),
+		(int)((uint64)unpackedSize * passes * 1000 / 1024 / ms));
+	return true;
+}
+
+bool Console::Cmd_Mixer(int argc, const char **argv) {
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		_vm->_mixer->resetStats();
+		debugPrintf("Mixer counters reset\n");
+		return true;
+	} else if (argc == 2 && (!scumm_stricmp(argv[1], "on") || !scumm_stricmp(argv[1], "off"))) {
+		_vm->_mixer->setTimingEnabled(!scumm_stricmp(argv[1], "on"));
+		debugPrintf("Mixer timing %s, counters reset\n", _vm->_mixer->isTimingEnabled() ? "enabled" : "disabled");
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Usage: %s [reset|on|off]\n", argv[0]);
+		return true;
+	}
+
+	static const char *const typeNames[] = { "plain", "music", "sfx", "speech" };
+	Audio::Mixer::Stats stats;
+	_vm->_mixer->getStats(stats);
+
+	debugPrintf("Callbacks: %d, late: %d, slow: %d, underruns: %d\n",
+		stats.callbacks, stats.lateCallbacks, stats.slowCallbacks, stats.underruns);
+	if (!_vm->_mixer->isTimingEnabled()) {
+		debugPrintf("Timing is disabled, use %s on to measure the callbacks\n", argv[0]);
+	} else if (stats.callbacks > 0) {
+		debugPrintf("Callback time: last %d us, average %d us, max %d us, buffer period %d us\n",
+			stats.lastCallbackTime, (int)(stats.totalCallbackTime / stats.callbacks), stats.maxCallbackTime, stats.bufferPeriod);
+		debugPrintf("Lock wait: average %d us, max %d us\n",
+			(int)(stats.totalLockWait / stats.callbacks), stats.maxLockWait);
+	}
+	debugPrintf("Active streams: %d plain, %d music, %d sfx, %d speech\n",
+		stats.activeStreams[0], stats.activeStreams[1], stats.activeStreams[2], stats.activeStreams[3]);
+
+	if (!stats.channels.empty()) {
+		debugPrintf("  id     type    rate        passes  mix us  flow us  read us  underruns\n");
+		for (uint i = 0; i < stats.channels.size(); i++) {
+			const Audio::Mixer::ChannelStats &channel = stats.channels[i];
+			// Times per pass, so long and short sounds compare
+			const uint32 passes = MAX<uint32>(channel.mixPasses, 1);
+			debugPrintf("  %-6d %-7s %5d %-6s %6d  %6d  %7d  %7d  %9d%s\n", channel.id, typeNames[channel.type],
+				channel.rate, channel.stereo ? "stereo" : "mono", channel.mixPasses,
+				(int)(channel.mixTime / passes), (int)(channel.flowTime / passes), (int)(channel.readTime / passes),
+				channel.underruns, channel.paused ? " (paused)" : "");
+		}
+	}
+	return true;
+}
+
 bool Console::Cmd_Dump(int argc, const char **argv) {
 	if (_vm->_gameModule->_childObject) {
 		((Scene *)((GameModule *)_vm->_gameModule->_childObject)->_childObject)->dumpPaletteData("_dump");
@@ -38,6 +38,11 @@ private:
 
 	bool Cmd_Scene(int argc, const char **argv);
 	bool Cmd_Surfaces(int argc, const char **argv);
+	bool Cmd_Video(int argc, const char **argv);
+	bool Cmd_SurfacePool(int argc, const char **argv);
+	bool Cmd_Resampler(int argc, const char **argv);
+	bool Cmd_Mixer(int argc, const char **argv);
+	bool Cmd_Decompress(int argc, const char **argv);
 	bool Cmd_Dump(int argc, const char **argv);
 	bool Cmd_Cheat(int argc, const char **argv);
 	bool Cmd_Dumpvars(int argc, const char **argv);
@@ -0,0 +1,79 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NEVERHOOD_DELTA_H
+#define NEVERHOOD_DELTA_H
+
+#include "common/scummsys.h"
+#include "neverhood/simd.h"
+
+namespace Neverhood {
+
+/**
+ * Expands 8-bit deltas to 16-bit samples. The running sum and the shift
+ * wrap around in 16 bits exactly like the original per-sample loop.
+ * prevValue holds the running sum and is updated for the next call.
+ */
+inline void decodeDeltaSamplesScalar(const byte *src, int16 *dest, int count, int16 &prevValue, byte shiftValue) {
+	while (count-- > 0) {
+		prevValue += (int8)(*src++);
+		*dest++ = prevValue << shiftValue;
+	}
+}
+
+#ifdef NEVERHOOD_SSE2
+
+/**
+ * Same as decodeDeltaSamplesScalar(), eight samples at a time. The samples
+ * left over are decoded by the scalar path.
+ */
+inline void decodeDeltaSamplesSSE2(const byte *src, int16 *dest, int count, int16 &prevValue, byte shiftValue) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i shift = _mm_cvtsi32_si128(shiftValue);
+	__m128i prev = _mm_set1_epi16(prevValue);
+	for (; count >= 8; count -= 8, src += 8, dest += 8) {
+		// Sign extend the deltas, then build the prefix sum in log2(8) steps
+		__m128i sum = _mm_srai_epi16(_mm_unpacklo_epi8(zero, _mm_loadl_epi64((const __m128i *)src)), 8);
+		sum = _mm_add_epi16(sum, _mm_slli_si128(sum, 2));
+		sum = _mm_add_epi16(sum, _mm_slli_si128(sum, 4));
+		sum = _mm_add_epi16(sum, _mm_slli_si128(sum, 8));
+		sum = _mm_add_epi16(sum, prev);
+		_mm_storeu_si128((__m128i *)dest, _mm_sll_epi16(sum, shift));
+		prev = _mm_shufflehi_epi16(sum, _MM_SHUFFLE(3, 3, 3, 3));
+		prev = _mm_unpackhi_epi64(prev, prev);
+	}
+	prevValue = (int16)_mm_extract_epi16(prev, 7);
+	decodeDeltaSamplesScalar(src, dest, count, prevValue, shiftValue);
+}
+
+#endif
+
+inline void decodeDeltaSamples(const byte *src, int16 *dest, int count, int16 &prevValue, byte shiftValue) {
+#ifdef NEVERHOOD_SSE2
+	decodeDeltaSamplesSSE2(src, dest, count, prevValue, shiftValue);
+#else
+	decodeDeltaSamplesScalar(src, dest, count, prevValue, shiftValue);
+#endif
+}
+
+} // End of namespace Neverhood
+
+#endif /* NEVERHOOD_DELTA_H */
@@ -45,6 +45,30 @@ Entity *MessageParam::asEntity() const {
 	return _entity;
 }
 
+void *Entity::operator new(size_t size) {
+	return ::operator new(size);
+}
+
+void *Entity::operator new(size_t size, SceneArena *arena) {
+	return arena->allocate(size);
+}
+
+void Entity::operator delete(void *ptr) {
+	if (!ptr)
+		return;
+	// Arena entities belong to their scene and must be deleted before it is
+	// gone, otherwise this would hand arena memory to the heap
+	SceneArena *arena = SceneArena::findOwner(ptr);
+	if (arena)
+		arena->release(ptr);
+	else
+		::operator delete(ptr);
+}
+
+void Entity::operator delete(void *ptr, SceneArena *arena) {
+	// Only called when a constructor throws, the arena keeps the memory
+}
+
 Entity::Entity(NeverhoodEngine *vm, int priority)
 	: _vm(vm), _updateHandlerCb(nullptr), _messageHandlerCb(nullptr), _priority(priority), _soundResources(nullptr) {
 }
@@ -26,6 +26,7 @@
 #include "neverhood/neverhood.h"
 #include "neverhood/gamevars.h"
 #include "neverhood/graphics.h"
+#include "neverhood/scenearena.h"
 #include "neverhood/sound.h"
 
 namespace Neverhood {
@@ -80,6 +81,13 @@ public:
 	Common::String _messageHandlerCbName;
 	Entity(NeverhoodEngine *vm, int priority);
 	virtual ~Entity();
+	// Entities owned by a scene can be placed in its arena with
+	// new (arena) T(...), delete then only runs the destructor and the arena
+	// releases the memory together with the scene
+	static void *operator new(size_t size);
+	static void *operator new(size_t size, SceneArena *arena);
+	static void operator delete(void *ptr);
+	static void operator delete(void *ptr, SceneArena *arena);
 	virtual void draw();
 	void handleUpdate();
 	uint32 receiveMessage(int messageNum, const MessageParam &param, Entity *sender);
@@ -30,6 +30,7 @@ GameVars::GameVars() {
 
 void GameVars::clear() {
 	_vars.clear();
+	_varIndices.clear();
 	addVar(0, 0);
 }
 
@@ -45,6 +46,7 @@ void GameVars::loadState(Common::InSaveFile *in) {
 		var.nextIndex = in->readUint16LE();
 		_vars.push_back(var);
 	}
+	rebuildVarIndices();
 }
 
 void GameVars::saveState(Common::OutSaveFile *out) {
@@ -94,11 +96,20 @@ int16 GameVars::addVar(uint32 nameHash, uint32 value) {
 	return _vars.size() - 1;
 }
 
+void GameVars::rebuildVarIndices() {
+	_varIndices.clear();
+	for (uint varIndex = 0; varIndex < _vars.size(); ++varIndex) {
+		for (int16 nextIndex = _vars[varIndex].firstIndex; nextIndex != -1; nextIndex = _vars[nextIndex].nextIndex) {
+			const uint64 key = varKey(varIndex, _vars[nextIndex].nameHash);
+			if (!_varIndices.contains(key))
+				_varIndices[key] = nextIndex;
+		}
+	}
+}
+
 int16 GameVars::findSubVarIndex(int16 varIndex, uint32 subNameHash) {
-	for (int16 nextIndex = _vars[varIndex].firstIndex; nextIndex != -1; nextIndex = _vars[nextIndex].nextIndex)
-		if (_vars[nextIndex].nameHash == subNameHash)
-			return nextIndex;
-	return -1;
+	int16 subVarIndex;
+	return _varIndices.tryGetVal(varKey(varIndex, subNameHash), subVarIndex) ? subVarIndex : -1;
 }
 
 int16 GameVars::addSubVar(int16 varIndex, uint32 subNameHash, uint32 value) {
@@ -113,6 +124,7 @@ int16 GameVars::addSubVar(int16 varIndex, uint32 subNameHash, uint32 value) {
 		subVarIndex = addVar(subNameHash, value);
 		_vars[nextIndex].nextIndex = subVarIndex;
 	}
+	_varIndices[varKey(varIndex, subNameHash)] = subVarIndex;
 	return subVarIndex;
 }
 
@@ -23,6 +23,7 @@
 #define NEVERHOOD_GAMEVARS_H
 
 #include "common/array.h"
+#include "common/flat-hashmap.h"
 #include "common/savefile.h"
 #include "neverhood/neverhood.h"
 
@@ -183,6 +184,17 @@ public:
 	void dumpVars(Console *con);
 protected:
 	Common::Array<GameVar> _vars;
+	// Index of each variable by the index of its parent and its name hash,
+	// so that lookups do not walk the lists in _vars, which stay the saved
+	// form. A name occurring twice in a list maps to the first one, as the
+	// lists are walked from the front.
+	struct VarKeyHash {
+		uint operator()(uint64 key) const { return (uint)(key >> 32) ^ (uint)key; }
+	};
+	typedef Common::FlatHashMap<uint64, int16, VarKeyHash> VarIndexMap;
+	VarIndexMap _varIndices;
+	static uint64 varKey(int16 varIndex, uint32 nameHash) { return ((uint64)(uint16)varIndex << 32) | nameHash; }
+	void rebuildVarIndices();
 	int16 addVar(uint32 nameHash, uint32 value);
 	int16 findSubVarIndex(int16 varIndex, uint32 subNameHash);
 	int16 addSubVar(int16 varIndex, uint32 subNameHash, uint32 value);
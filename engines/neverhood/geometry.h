@@ -0,0 +1,129 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NEVERHOOD_GEOMETRY_H
+#define NEVERHOOD_GEOMETRY_H
+
+#include "common/array.h"
+#include "common/util.h"
+
+namespace Neverhood {
+
+/**
+ * Coordinates are kept in 32 bits throughout the engine. At the larger
+ * upscale ratios the screen space no longer fits into int16, an 8K back
+ * buffer alone already needs a 30720 byte pitch.
+ */
+typedef int32 NCoord;
+
+/**
+ * Byte distance between two pixel rows. Unsigned and 32 bits wide so it
+ * cannot wrap for any surface size the engine accepts.
+ */
+typedef uint32 NPitch;
+
+/**
+ * Largest pitch a Graphics::Surface can hold, its pitch member is an int16.
+ * Surfaces are checked against this instead of silently wrapping around.
+ */
+const NPitch kMaxSurfacePitch = 0x7FFF;
+
+/**
+ * Returns the pitch of a packed surface, or 0 if the size is invalid or
+ * the pitch would not fit into 31 bits.
+ */
+inline NPitch calcPitch(NCoord width, uint bytesPerPixel) {
+	if (width <= 0 || bytesPerPixel == 0 || (uint32)width > 0x7FFFFFFF / bytesPerPixel)
+		return 0;
+	return (NPitch)width * bytesPerPixel;
+}
+
+/**
+ * Returns the byte offset of pixel (x, y), computed in 32 bits so that rows
+ * past the int16 limit are addressed correctly.
+ */
+inline uint32 calcPixelOffset(NCoord x, NCoord y, NPitch pitch, uint bytesPerPixel) {
+	return (uint32)y * pitch + (uint32)x * bytesPerPixel;
+}
+
+struct NPoint {
+	NCoord x, y;
+};
+
+typedef Common::Array<NPoint> NPointArray;
+
+struct NDimensions {
+	NCoord width, height;
+
+	NDimensions() : width(0), height(0) {}
+};
+
+struct NRect {
+	NCoord x1, y1, x2, y2;
+
+	static NRect make(NCoord x01, NCoord y01, NCoord x02, NCoord y02) {
+		NRect r;
+		r.set(x01, y01, x02, y02);
+		return r;
+	}
+
+	void set(NCoord x01, NCoord y01, NCoord x02, NCoord y02) {
+		x1 = x01;
+		y1 = y01;
+		x2 = x02;
+		y2 = y02;
+	}
+
+	bool contains(NCoord x, NCoord y) const {
+		return x >= x1 && x <= x2 && y >= y1 && y <= y2;
+	}
+
+	NCoord width() const { return x2 - x1; }
+	NCoord height() const { return y2 - y1; }
+
+	void clip(const NRect &r) {
+		x1 = CLIP(x1, r.x1, r.x2);
+		y1 = CLIP(y1, r.y1, r.y2);
+		x2 = CLIP(x2, r.x1, r.x2);
+		y2 = CLIP(y2, r.y1, r.y2);
+	}
+
+};
+
+typedef Common::Array<NRect> NRectArray;
+
+struct NDrawRect {
+	NCoord x, y, width, height;
+	NDrawRect() : x(0), y(0), width(0), height(0) {}
+	NDrawRect(NCoord x0, NCoord y0, NCoord width0, NCoord height0) : x(x0), y(y0), width(width0), height(height0) {}
+	NCoord x2() { return x + width; }
+	NCoord y2() { return y + height; }
+	void set(NCoord x0, NCoord y0, NCoord width0, NCoord height0) {
+		x = x0;
+		y = y0;
+		width = width0;
+		height = height0;
+	}
+};
+
+} // End of namespace Neverhood
+
+#endif /* NEVERHOOD_GEOMETRY_H */
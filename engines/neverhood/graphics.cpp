@@ -25,7 +25,7 @@
 
 namespace Neverhood {
 
-BaseSurface::BaseSurface(NeverhoodEngine *vm, int priority, int16 width, int16 height, Common::String name)
+BaseSurface::BaseSurface(NeverhoodEngine *vm, int priority, NCoord width, NCoord height, Common::String name)
 	: _vm(vm), _priority(priority), _visible(true), _transparent(true),
 	  _clipRects(nullptr), _clipRectsCount(0), _version(0), _name(name), _lastResourceFileHash(0) {
 
@@ -41,17 +41,26 @@ BaseSurface::BaseSurface(NeverhoodEngine *vm, int priority, int16 width, int16 h
 	_clipRect.y1 = UPSCALE_Y(0);
 	_clipRect.x2 = UPSCALE_X(640);
 	_clipRect.y2 = UPSCALE_Y(480);
+	if (calcPitch(_sysRect.width, 4) > kMaxSurfacePitch)
+		error("BaseSurface::BaseSurface() Surface '%s' is too wide (%d pixels)", name.c_str(), _sysRect.width);
 	_surface = new Graphics::Surface();
-	_surface->create(_sysRect.width, _sysRect.height, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24)); //Graphics::PixelFormat::createFormatCLUT8());
+	_surface->init(_sysRect.width, _sysRect.height, calcPitch(_sysRect.width, 4), nullptr, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24)); //Graphics::PixelFormat::createFormatCLUT8());
 }
 
 BaseSurface::~BaseSurface() {
-	_surface->free();
+	if (_surface->getPixels())
+		_vm->_screen->getSurfacePool()->release((byte*)_surface->getPixels(), _surface->pitch * _surface->h);
 	delete _surface;
 }
 
+void BaseSurface::ensurePixels() {
+	if (!_surface->getPixels())
+		_surface->setPixels(_vm->_screen->getSurfacePool()->allocate(_surface->pitch * _surface->h));
+}
+
 void BaseSurface::draw() {
 	if (_surface && _visible && _drawRect.width > 0 && _drawRect.height > 0) {
+		ensurePixels();
 		if (_clipRects && _clipRectsCount) {
 			_vm->_screen->drawSurfaceClipRects(_surface, _drawRect, _clipRects, _clipRectsCount, _transparent, _version);
 		} else if (_sysRect.x == 0 && _sysRect.y == 0) {
@@ -63,7 +72,9 @@ void BaseSurface::draw() {
 }
 
 void BaseSurface::clear() {
-	_surface->fillRect(Common::Rect(0, 0, _surface->w, _surface->h), 0);
+	// A surface without pixels yet is still cleared, its buffer comes zeroed
+	if (hasPixels())
+		_surface->fillRect(Common::Rect(0, 0, _surface->w, _surface->h), 0);
 	++_version;
 }
 
@@ -71,6 +82,7 @@ void BaseSurface::drawSpriteResource(SpriteResource &spriteResource) {
 	if (spriteResource.getDimensions().width <= _drawRect.width &&
 		spriteResource.getDimensions().height <= _drawRect.height) {
 		clear();
+		ensurePixels();
 		spriteResource.draw(_surface, false, false);
 		_lastResourceFileHash = spriteResource.getFileHash();
 		++_version;
@@ -79,7 +91,7 @@ void BaseSurface::drawSpriteResource(SpriteResource &spriteResource) {
 
 }
 
-void BaseSurface::drawSpriteResourceEx(SpriteResource &spriteResource, bool flipX, bool flipY, int16 width, int16 height) {
+void BaseSurface::drawSpriteResourceEx(SpriteResource &spriteResource, bool flipX, bool flipY, NCoord width, NCoord height) {
 	if (spriteResource.getDimensions().width <= _sysRect.width &&
 		spriteResource.getDimensions().height <= _sysRect.height) {
 		if (width > 0 && width <= _sysRect.width)
@@ -88,6 +100,7 @@ void BaseSurface::drawSpriteResourceEx(SpriteResource &spriteResource, bool flip
 			_drawRect.height = height;
 		if (_surface) {
 			clear();
+			ensurePixels();
 			spriteResource.draw(_surface, flipX, flipY);
 			_lastResourceFileHash = spriteResource.getFileHash();
 			++_version;
@@ -95,13 +108,14 @@ void BaseSurface::drawSpriteResourceEx(SpriteResource &spriteResource, bool flip
 	}
 }
 
-void BaseSurface::drawAnimResource(AnimResource &animResource, uint frameIndex, bool flipX, bool flipY, int16 width, int16 height) {
+void BaseSurface::drawAnimResource(AnimResource &animResource, uint frameIndex, bool flipX, bool flipY, NCoord width, NCoord height) {
 	if (width > 0 && width <= _sysRect.width)
 		_drawRect.width = width;
 	if (height > 0 && height <= _sysRect.height)
 		_drawRect.height = height;
 	if (_surface) {
 		clear();
+		ensurePixels();
 		if (frameIndex < animResource.getFrameCount()) {
 			animResource.draw(frameIndex, _surface, flipX, flipY);
 			_lastResourceFileHash = animResource.getFileHash();
@@ -112,29 +126,32 @@ void BaseSurface::drawAnimResource(AnimResource &animResource, uint frameIndex,
 
 void BaseSurface::drawMouseCursorResource(MouseCursorResource &mouseCursorResource, int frameNum) {
 	if (frameNum < 3) {
+		ensurePixels();
 		mouseCursorResource.draw(frameNum, _surface);
 		_lastResourceFileHash = mouseCursorResource.getFileHash();
 		++_version;
 	}
 }
 
-void BaseSurface::copyFrom(Graphics::Surface *sourceSurface, int16 x, int16 y, NDrawRect &sourceRect) {
-	// Copy a rectangle from sourceSurface, 0 is the transparent color
+void BaseSurface::copyFrom(Graphics::Surface *sourceSurface, NCoord x, NCoord y, NDrawRect &sourceRect) {
+	// Copy a rectangle from sourceSurface, pixels with an alpha of 0 are transparent
 	// Clipping is performed against the right/bottom border since x, y will always be >= 0
 
+	ensurePixels();
 	if (x + sourceRect.width > _surface->w)
 		sourceRect.width = _surface->w - x - 1;
 
 	if (y + sourceRect.height > _surface->h)
 		sourceRect.height = _surface->h - y - 1;
 
-	byte *source = (byte*)sourceSurface->getBasePtr(sourceRect.x, sourceRect.y);
-	byte *dest = (byte*)_surface->getBasePtr(x, y);
+	const byte *source = getPixelPtr(sourceSurface, sourceRect.x, sourceRect.y);
+	byte *dest = getPixelPtr(_surface, x, y);
+	const int alphaOffset = getAlphaOffset(0, 4);
 	int height = sourceRect.height;
 	while (height--) {
-		for (int xc = 0; xc < sourceRect.width; xc++)
-			if (source[xc] != 0)
-				dest[xc] = source[xc];
+		for (int xc = 0; xc < sourceRect.width * 4; xc += 4)
+			if (source[xc + alphaOffset] != 0)
+				blendColor(dest + xc, source + xc, 4, nullptr);
 		source += sourceSurface->pitch;
 		dest += _surface->pitch;
 	}
@@ -143,64 +160,174 @@ void BaseSurface::copyFrom(Graphics::Surface *sourceSurface, int16 x, int16 y, N
 
 // ShadowSurface
 
-ShadowSurface::ShadowSurface(NeverhoodEngine *vm, int priority, int16 width, int16 height, BaseSurface *shadowSurface)
+ShadowSurface::ShadowSurface(NeverhoodEngine *vm, int priority, NCoord width, NCoord height, BaseSurface *shadowSurface)
 	: BaseSurface(vm, priority, width, height, "shadow"), _shadowSurface(shadowSurface) {
 	// Empty
 }
 
 void ShadowSurface::draw() {
 	if (_surface && _visible && _drawRect.width > 0 && _drawRect.height > 0) {
-		_vm->_screen->drawSurface2(_surface, _drawRect, _clipRect, _transparent, _version, _shadowSurface->getSurface());
+		ensurePixels();
+		_vm->_screen->drawSurface2(_surface, _drawRect, _clipRect, _transparent, _version, _shadowSurface->getPixelSurface());
 	}
 }
 
 // FontSurface
 
+static const uint kMaxCachedLayouts = 64;
+
+// The font metrics come from the original resources, the glyphs themselves
+// are drawn at the upscaled size
 FontSurface::FontSurface(NeverhoodEngine *vm, NPointArray *tracking, uint charsPerRow, uint16 numRows, byte firstChar, uint16 charWidth, uint16 charHeight)
-	: BaseSurface(vm, 0, charWidth * charsPerRow, charHeight * numRows, "font"), _charsPerRow(charsPerRow), _numRows(numRows),
-	_firstChar(firstChar), _charWidth(charWidth), _charHeight(charHeight), _tracking(nullptr) {
+	: BaseSurface(vm, 0, UPSCALE_X(charWidth) * charsPerRow, UPSCALE_Y(charHeight) * numRows, "font"), _charsPerRow(charsPerRow), _numRows(numRows),
+	_firstChar(firstChar), _charWidth(UPSCALE_X(charWidth)), _charHeight(UPSCALE_Y(charHeight)), _tracking(nullptr), _layoutUseCounter(0) {
 
 	_tracking = new NPointArray();
 	*_tracking = *tracking;
+	for (NPointArray::iterator it = _tracking->begin(); it != _tracking->end(); ++it)
+		(*it).x = UPSCALE_X((*it).x);
 
 }
 
 FontSurface::FontSurface(NeverhoodEngine *vm, uint32 fileHash, uint charsPerRow, uint16 numRows, byte firstChar, uint16 charWidth, uint16 charHeight)
-	: BaseSurface(vm, 0, charWidth * charsPerRow, charHeight * numRows, "font"), _charsPerRow(charsPerRow), _numRows(numRows),
-	_firstChar(firstChar), _charWidth(charWidth), _charHeight(charHeight), _tracking(nullptr) {
+	: BaseSurface(vm, 0, UPSCALE_X(charWidth) * charsPerRow, UPSCALE_Y(charHeight) * numRows, "font"), _charsPerRow(charsPerRow), _numRows(numRows),
+	_firstChar(firstChar), _charWidth(UPSCALE_X(charWidth)), _charHeight(UPSCALE_Y(charHeight)), _tracking(nullptr), _layoutUseCounter(0) {
 
 	SpriteResource fontSpriteResource(_vm);
 	fontSpriteResource.load(fileHash, true);
 	drawSpriteResourceEx(fontSpriteResource, false, false, 0, 0);
+	buildGlyphAtlas();
 }
 
 FontSurface::~FontSurface() {
 	delete _tracking;
 }
 
-void FontSurface::drawChar(BaseSurface *destSurface, int16 x, int16 y, byte chr) {
-	NDrawRect sourceRect;
-	chr -= _firstChar;
-	sourceRect.x = (chr % _charsPerRow) * _charWidth;
-	sourceRect.y = (chr / _charsPerRow) * _charHeight;
-	sourceRect.width = _charWidth;
-	sourceRect.height = _charHeight;
-	destSurface->copyFrom(_surface, x, y, sourceRect);
+void FontSurface::buildGlyphAtlas() {
+	// Split every glyph cell into runs of visible pixels once, so drawing a
+	// character only touches the pixels that are actually set
+	const int alphaOffset = getAlphaOffset(0, 4);
+
+	ensurePixels();
+	_glyphSpans.clear();
+	_glyphs.resize(_charsPerRow * _numRows);
+	_layoutCache.clear();
+
+	for (uint glyphIndex = 0; glyphIndex < _glyphs.size(); glyphIndex++) {
+		Glyph &glyph = _glyphs[glyphIndex];
+		glyph.cellX = (glyphIndex % _charsPerRow) * _charWidth;
+		glyph.cellY = (glyphIndex / _charsPerRow) * _charHeight;
+		glyph.firstSpan = _glyphSpans.size();
+		for (uint16 yc = 0; yc < _charHeight && glyph.cellY + yc < _surface->h; yc++) {
+			const byte *source = getPixelPtr(_surface, glyph.cellX, glyph.cellY + yc);
+			const uint16 cellWidth = MIN<NCoord>(_charWidth, _surface->w - glyph.cellX);
+			uint16 xc = 0;
+			while (xc < cellWidth) {
+				const byte alpha = source[xc * 4 + alphaOffset];
+				if (alpha == 0) {
+					xc++;
+					continue;
+				}
+				GlyphSpan span;
+				span.x = xc;
+				span.y = yc;
+				span.opaque = alpha == 0xFF;
+				while (xc < cellWidth && source[xc * 4 + alphaOffset] != 0 &&
+					(source[xc * 4 + alphaOffset] == 0xFF) == span.opaque)
+					xc++;
+				span.width = xc - span.x;
+				_glyphSpans.push_back(span);
+			}
+		}
+		glyph.spanCount = _glyphSpans.size() - glyph.firstSpan;
+	}
 }
 
-void FontSurface::drawString(BaseSurface *destSurface, int16 x, int16 y, const byte *string, int stringLen) {
+const FontSurface::TextLayout &FontSurface::getLayout(const byte *string, int stringLen) {
+	const Common::String key((const char*)string, stringLen);
 
-	if (stringLen < 0)
-		stringLen = strlen((const char*)string);
+	TextLayoutCache::iterator it = _layoutCache.find(key);
+	if (it != _layoutCache.end()) {
+		it->_value.lastUse = ++_layoutUseCounter;
+		return it->_value.layout;
+	}
+
+	// Evict the least recently drawn string, so the labels a menu redraws
+	// every frame stay cached while its list is scrolled
+	if (_layoutCache.size() >= kMaxCachedLayouts) {
+		TextLayoutCache::iterator oldest = _layoutCache.begin();
+		for (it = _layoutCache.begin(); it != _layoutCache.end(); ++it)
+			if (it->_value.lastUse < oldest->_value.lastUse)
+				oldest = it;
+		_layoutCache.erase(oldest);
+	}
 
+	CachedLayout &cachedLayout = _layoutCache[key];
+	cachedLayout.lastUse = ++_layoutUseCounter;
+	TextLayout &layout = cachedLayout.layout;
+	NCoord x = 0;
 	for (; stringLen > 0; --stringLen, ++string) {
-		drawChar(destSurface, x, y, *string);
-		x += _tracking ? (*_tracking)[*string - _firstChar].x : _charWidth;
+		const uint glyphIndex = (byte)(*string - _firstChar);
+		if (glyphIndex < _glyphs.size() && _glyphs[glyphIndex].spanCount > 0) {
+			GlyphPlacement placement;
+			placement.glyphIndex = glyphIndex;
+			placement.x = x;
+			layout.push_back(placement);
+		}
+		x += _tracking && glyphIndex < _tracking->size() ? (*_tracking)[glyphIndex].x : _charWidth;
 	}
+	return layout;
+}
 
+void FontSurface::drawGlyph(Graphics::Surface *destSurface, NCoord x, NCoord y, const Glyph &glyph) {
+	const GlyphSpan *span = &_glyphSpans[glyph.firstSpan];
+	for (uint i = 0; i < glyph.spanCount; i++, span++) {
+		const NCoord destY = y + span->y;
+		NCoord destX = x + span->x;
+		NCoord srcX = glyph.cellX + span->x;
+		NCoord width = span->width;
+		if (destY < 0 || destY >= destSurface->h)
+			continue;
+		if (destX < 0) {
+			width += destX;
+			srcX -= destX;
+			destX = 0;
+		}
+		width = MIN<NCoord>(width, destSurface->w - destX);
+		if (width <= 0)
+			continue;
+		const byte *source = getPixelPtr(_surface, srcX, glyph.cellY + span->y);
+		byte *dest = getPixelPtr(destSurface, destX, destY);
+		if (span->opaque) {
+			memcpy(dest, source, width * 4);
+		} else {
+			for (NCoord xc = 0; xc < width * 4; xc += 4)
+				blendColor(dest + xc, source + xc, 4, nullptr);
+		}
+	}
 }
 
-int16 FontSurface::getStringWidth(const byte *string, int stringLen) {
+void FontSurface::drawChar(BaseSurface *destSurface, NCoord x, NCoord y, byte chr) {
+	const uint glyphIndex = (byte)(chr - _firstChar);
+	if (glyphIndex < _glyphs.size()) {
+		drawGlyph(destSurface->getPixelSurface(), x, y, _glyphs[glyphIndex]);
+		destSurface->incVersion();
+	}
+}
+
+void FontSurface::drawString(BaseSurface *destSurface, NCoord x, NCoord y, const byte *string, int stringLen) {
+
+	if (stringLen < 0)
+		stringLen = strlen((const char*)string);
+
+	const TextLayout &layout = getLayout(string, stringLen);
+	for (TextLayout::const_iterator it = layout.begin(); it != layout.end(); ++it)
+		drawGlyph(destSurface->getPixelSurface(), x + (*it).x, y, _glyphs[(*it).glyphIndex]);
+	destSurface->incVersion();
+
+}
+
+NCoord FontSurface::getStringWidth(const byte *string, int stringLen) {
 	return string ? stringLen * _charWidth : 0;
 }
 
@@ -217,6 +344,7 @@ FontSurface *FontSurface::createFontSurface(NeverhoodEngine *vm, uint32 fileHash
 	fontSprite.load(fileHash, true);
 	fontSurface = new FontSurface(vm, tracking, 16, numRows, firstChar, charWidth, charHeight);
 	fontSurface->drawSpriteResourceEx(fontSprite, false, false, 0, 0);
+	fontSurface->buildGlyphAtlas();
 	return fontSurface;
 }
 
@@ -294,7 +422,7 @@ void unpackSpriteRle(const byte *source, int width, int height, byte *dest, int
 	int16 skip, copy;
 
 	if (flipY) {
-		dest += destPitch * (height - 1);
+		dest += calcPixelOffset(0, height - 1, destPitch, 0);
 		destPitch = -destPitch;
 	}
 
@@ -336,52 +464,13 @@ void unpackSpriteRle(const byte *source, int width, int height, byte *dest, int
 
 }
 
-int getAlphaOffset(int pos, int bytes_per_pixel) {
-	return (pos & 0xFFFFFFFC) + bytes_per_pixel - 1;
-}
-
-byte clampByte(int16 val) {
-	return (byte)((val < 0) ? 0 : (val > 255) ? 255
-											  : val);
-}
-
-void blendColor(byte *dst, const byte *src, int16 bytes_per_pixel, const Graphics::RgbOffset* rgb_offset) {
-	int16 min = 0;
-	int16 max = 255;
-	int16 width = max - min;
-
-	byte src_pixel[4];
-	memcpy(src_pixel, src, bytes_per_pixel);
-
-	if (rgb_offset) {
-		rgb_offset->applyTo(&src_pixel[0]);
-	}
-
-	int16 dst_alpha = dst[getAlphaOffset(0, bytes_per_pixel)];
-
-	if (dst_alpha == 0) {
-		memcpy(dst, src_pixel, bytes_per_pixel);
-		return;
-	}
-
-	int16 src_alpha = src_pixel[getAlphaOffset(0, bytes_per_pixel)];
-	if (src_alpha >= max) {
-		memcpy(dst, src_pixel, bytes_per_pixel);
-	} else if (src_alpha >= min) {
-		float falpha = (src_alpha - min) / (float)width;
-		for (int i = 0; i < bytes_per_pixel; ++i) {
-			dst[i] = clampByte(src_pixel[i] * falpha + dst[i] * (1.f - falpha));
-		}
-	}
-}
-
 void unpackSpriteUpscaled(const byte *source, int width, int height, byte *dest, int destPitch, bool flipX, bool flipY, const Graphics::RgbOffset* rgbOffset) {
 
 	const int bytesPerPixel = 4;
 	const int sourcePitch = width * bytesPerPixel;
 
 	if (flipY) {
-		dest += destPitch * (height - 1);
+		dest += calcPixelOffset(0, height - 1, destPitch, 0);
 		destPitch = -destPitch;
 	}
 
@@ -410,7 +499,7 @@ void unpackSpriteNormal(const byte *source, int width, int height, byte *dest, i
 	const int sourcePitch = (width + 3) & 0xFFFC;
 
 	if (flipY) {
-		dest += destPitch * (height - 1);
+		dest += calcPixelOffset(0, height - 1, destPitch, 0);
 		destPitch = -destPitch;
 	}
 
@@ -432,9 +521,9 @@ void unpackSpriteNormal(const byte *source, int width, int height, byte *dest, i
 
 }
 
-int calcDistance(int16 x1, int16 y1, int16 x2, int16 y2) {
-	const int16 deltaX = ABS(x1 - x2);
-	const int16 deltaY = ABS(y1 - y2);
+int calcDistance(NCoord x1, NCoord y1, NCoord x2, NCoord y2) {
+	const NCoord deltaX = ABS(x1 - x2);
+	const NCoord deltaY = ABS(y1 - y2);
 	return (int)sqrt((double)(deltaX * deltaX + deltaY * deltaY));
 }
 
@@ -24,77 +24,30 @@
 
 #include "common/array.h"
 #include "common/file.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "graphics/surface.h"
 #include "neverhood/neverhood.h"
+#include "neverhood/blend.h"
+#include "neverhood/geometry.h"
 
 namespace Neverhood {
 
-struct NPoint {
-	int16 x, y;
-};
-
-typedef Common::Array<NPoint> NPointArray;
-
-struct NDimensions {
-	int16 width, height;
-
-	NDimensions() : width(0), height(0) {}
-};
-
-struct NRect {
-	int16 x1, y1, x2, y2;
-
-	static NRect make(int16 x01, int16 y01, int16 x02, int16 y02) {
-		NRect r;
-		r.set(x01, y01, x02, y02);
-		return r;
-	}
-
-	void set(int16 x01, int16 y01, int16 x02, int16 y02) {
-		x1 = x01;
-		y1 = y01;
-		x2 = x02;
-		y2 = y02;
-	}
-
-	bool contains(int16 x, int16 y) const {
-		return x >= x1 && x <= x2 && y >= y1 && y <= y2;
-	}
-
-};
-
-typedef Common::Array<NRect> NRectArray;
-
-// TODO: Use Common::Rect
-struct NDrawRect {
-	int16 x, y, width, height;
-	NDrawRect() : x(0), y(0), width(0), height(0) {}
-	NDrawRect(int16 x0, int16 y0, int16 width0, int16 height0) : x(x0), y(y0), width(width0), height(height0) {}
-	int16 x2() { return x + width; }
-	int16 y2() { return y + height; }
-	void set(int16 x0, int16 y0, int16 width0, int16 height0) {
-		x = x0;
-		y = y0;
-		width = width0;
-		height = height0;
-	}
-};
-
 class AnimResource;
 class SpriteResource;
 class MouseCursorResource;
 
 class BaseSurface {
 public:
-	BaseSurface(NeverhoodEngine *vm, int priority, int16 width, int16 height, Common::String name);
+	BaseSurface(NeverhoodEngine *vm, int priority, NCoord width, NCoord height, Common::String name);
 	virtual ~BaseSurface();
 	virtual void draw();
 	void clear();
 	void drawSpriteResource(SpriteResource &spriteResource);
-	void drawSpriteResourceEx(SpriteResource &spriteResource, bool flipX, bool flipY, int16 width, int16 height);
-	void drawAnimResource(AnimResource &animResource, uint frameIndex, bool flipX, bool flipY, int16 width, int16 height);
+	void drawSpriteResourceEx(SpriteResource &spriteResource, bool flipX, bool flipY, NCoord width, NCoord height);
+	void drawAnimResource(AnimResource &animResource, uint frameIndex, bool flipX, bool flipY, NCoord width, NCoord height);
 	void drawMouseCursorResource(MouseCursorResource &mouseCursorResource, int frameNum);
-	void copyFrom(Graphics::Surface *sourceSurface, int16 x, int16 y, NDrawRect &sourceRect);
+	void copyFrom(Graphics::Surface *sourceSurface, NCoord x, NCoord y, NDrawRect &sourceRect);
 	int getPriority() const { return _priority; }
 	void setPriority(int priority) { _priority = priority; }
 	NDrawRect& getDrawRect() { return _drawRect; }
@@ -106,9 +59,14 @@ public:
 	bool getVisible() const { return _visible; }
 	void setVisible(bool value) { _visible = value; }
 	void setTransparent(bool value) { _transparent = value; }
+	// The surface may have no pixels yet, use getPixelSurface() to draw into
+	// or read from it
 	Graphics::Surface *getSurface() { return _surface; }
+	Graphics::Surface *getPixelSurface() { ensurePixels(); return _surface; }
+	bool hasPixels() const { return _surface->getPixels() != nullptr; }
 	const Common::String getName() const { return _name; }
 	uint32 getLastResourceFileHash() const { return _lastResourceFileHash; }
+	void incVersion() { ++_version; }
 
 protected:
 	NeverhoodEngine *_vm;
@@ -126,11 +84,15 @@ protected:
 	byte _version;
 
 	uint32 _lastResourceFileHash;
+
+	// The pixels are taken from the screen's surface pool on first use, so
+	// surfaces which are created but never drawn into cost nothing
+	void ensurePixels();
 };
 
 class ShadowSurface : public BaseSurface {
 public:
-	ShadowSurface(NeverhoodEngine *vm, int priority, int16 width, int16 height, BaseSurface *shadowSurface);
+	ShadowSurface(NeverhoodEngine *vm, int priority, NCoord width, NCoord height, BaseSurface *shadowSurface);
 	void draw() override;
 protected:
 	BaseSurface *_shadowSurface;
@@ -141,19 +103,46 @@ public:
 	FontSurface(NeverhoodEngine *vm, NPointArray *tracking, uint charsPerRow, uint16 numRows, byte firstChar, uint16 charWidth, uint16 charHeight);
 	FontSurface(NeverhoodEngine *vm, uint32 fileHash, uint charsPerRow, uint16 numRows, byte firstChar, uint16 charWidth, uint16 charHeight);
 	~FontSurface() override;
-	void drawChar(BaseSurface *destSurface, int16 x, int16 y, byte chr);
-	void drawString(BaseSurface *destSurface, int16 x, int16 y, const byte *string, int stringLen = -1);
-	int16 getStringWidth(const byte *string, int stringLen);
+	void drawChar(BaseSurface *destSurface, NCoord x, NCoord y, byte chr);
+	void drawString(BaseSurface *destSurface, NCoord x, NCoord y, const byte *string, int stringLen = -1);
+	NCoord getStringWidth(const byte *string, int stringLen);
 	uint16 getCharWidth() const { return _charWidth; }
 	uint16 getCharHeight() const { return _charHeight; }
 	static FontSurface *createFontSurface(NeverhoodEngine *vm, uint32 fileHash);
 protected:
+	// A horizontal run of visible pixels in a glyph, relative to the glyph cell
+	struct GlyphSpan {
+		uint16 x, y, width;
+		bool opaque;
+	};
+	struct Glyph {
+		NCoord cellX, cellY;
+		uint firstSpan, spanCount;
+	};
+	struct GlyphPlacement {
+		uint16 glyphIndex;
+		NCoord x;
+	};
+	typedef Common::Array<GlyphPlacement> TextLayout;
+	struct CachedLayout {
+		TextLayout layout;
+		uint32 lastUse;
+	};
+	typedef Common::HashMap<Common::String, CachedLayout> TextLayoutCache;
+
 	uint _charsPerRow;
 	uint16 _numRows;
 	byte _firstChar;
 	uint16 _charWidth;
 	uint16 _charHeight;
 	NPointArray *_tracking;
+	Common::Array<GlyphSpan> _glyphSpans;
+	Common::Array<Glyph> _glyphs;
+	TextLayoutCache _layoutCache;
+	uint32 _layoutUseCounter;
+	void buildGlyphAtlas();
+	const TextLayout &getLayout(const byte *string, int stringLen);
+	void drawGlyph(Graphics::Surface *destSurface, NCoord x, NCoord y, const Glyph &glyph);
 };
 
 // Misc
@@ -162,11 +151,16 @@ void parseBitmapResource(const byte *sprite, bool *rle, NDimensions *dimensions,
 void unpackSpriteRle(const byte *source, int width, int height, byte *dest, int destPitch, bool flipX, bool flipY, byte oldColor = 0, byte newColor = 0);
 void unpackSpriteNormal(const byte *source, int width, int height, byte *dest, int destPitch, bool flipX, bool flipY);
 void unpackSpriteUpscaled(const byte *source, int width, int height, byte *dest, int destPitch, bool flipX, bool flipY, const Graphics::RgbOffset *rgbOffset);
-int calcDistance(int16 x1, int16 y1, int16 x2, int16 y2);
+int calcDistance(NCoord x1, NCoord y1, NCoord x2, NCoord y2);
+
+// Like Graphics::Surface::getBasePtr, with the row offset computed by calcPixelOffset
+inline byte *getPixelPtr(Graphics::Surface *surface, NCoord x, NCoord y) {
+	return (byte *)surface->getPixels() + calcPixelOffset(x, y, surface->pitch, surface->format.bytesPerPixel);
+}
 
-int getAlphaOffset(int pos, int bytes_per_pixel);
-byte clampByte(int16 val);
-void blendColor(byte *dst, const byte *src, int16 bytes_per_pixel, const Graphics::RgbOffset *rgb_offset);
+inline const byte *getPixelPtr(const Graphics::Surface *surface, NCoord x, NCoord y) {
+	return (const byte *)surface->getPixels() + calcPixelOffset(x, y, surface->pitch, surface->format.bytesPerPixel);
+}
 
 } // End of namespace Neverhood
 
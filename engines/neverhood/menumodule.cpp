@@ -305,6 +305,11 @@ void MenuModule::loadSavegameList() {
 
 }
 
+// The menu layouts are given in the original 640x480 coordinates
+static NRect upscaleRect(const NRect &rect) {
+	return NRect::make(UPSCALE(rect.x1, rect.y1), UPSCALE(rect.x2, rect.y2));
+}
+
 MenuButton::MenuButton(NeverhoodEngine *vm, Scene *parentScene, uint buttonIndex, uint32 fileHash, const NRect &collisionBounds)
 	: StaticSprite(vm, 900), _parentScene(parentScene), _buttonIndex(buttonIndex), _countdown(0) {
 
@@ -377,14 +382,8 @@ MainMenu::MainMenu(NeverhoodEngine *vm, Module *parentModule)
 		insertStaticSprite(0x0C24C0EE, 100);	// "Music is off" button
 
 	for (uint buttonIndex = 0; buttonIndex < 9; ++buttonIndex) {
-		NRect rect = kMenuButtonCollisionBounds[buttonIndex];
-		rect.x1 = UPSCALE_X(rect.x1);
-		rect.x2 = UPSCALE_X(rect.x2);
-		rect.y1 = UPSCALE_X(rect.y1);
-		rect.y2 = UPSCALE_X(rect.y2);
-
 		Sprite *menuButton = insertSprite<MenuButton>(this, buttonIndex,
-			kMenuButtonFileHashes[buttonIndex], rect);
+			kMenuButtonFileHashes[buttonIndex], upscaleRect(kMenuButtonCollisionBounds[buttonIndex]));
 		addCollisionSprite(menuButton);
 	}
 
@@ -680,7 +679,7 @@ void TextEditWidget::setCursor(uint32 cursorFileHash, int16 cursorWidth, int16 c
 void TextEditWidget::drawCursor() {
 	if (_cursorSurface->getVisible() && _cursorPos >= 0 && _cursorPos <= _maxVisibleChars) {
 		NDrawRect sourceRect(0, 0, _cursorWidth, _cursorHeight);
-		_surface->copyFrom(_cursorSurface->getSurface(), _rect.x1 + _cursorPos * _fontSurface->getCharWidth(),
+		_surface->copyFrom(_cursorSurface->getPixelSurface(), _rect.x1 + _cursorPos * _fontSurface->getCharWidth(),
 			_rect.y1 + (_rect.y2 - _cursorHeight - _rect.y1 + 1) / 2, sourceRect);
 	} else if (!_readOnly)
 		_cursorSurface->setVisible(false);
@@ -948,18 +947,24 @@ GameStateMenu::GameStateMenu(NeverhoodEngine *vm, Module *parentModule, Savegame
 
 	setBackground(backgroundFileHash);
 	setPalette(backgroundFileHash);
-	insertScreenMouse(mouseFileHash, mouseRect);
+	if (mouseRect) {
+		const NRect upscaledMouseRect = upscaleRect(*mouseRect);
+		insertScreenMouse(mouseFileHash, &upscaledMouseRect);
+	} else
+		insertScreenMouse(mouseFileHash);
 	insertStaticSprite(textFileHash1, 200);
 	insertStaticSprite(textFileHash2, 200);
 
-	_listBox = new SavegameListBox(_vm, listBoxX, listBoxY, this,
-		_savegameList, _fontSurface, listBoxBackgroundFileHash, listBoxRect);
+	// The widgets lay out their text in screen coordinates, like the font
+	// metrics they divide them by
+	_listBox = new SavegameListBox(_vm, UPSCALE(listBoxX, listBoxY), this,
+		_savegameList, _fontSurface, listBoxBackgroundFileHash, upscaleRect(listBoxRect));
 	_listBox->initialize();
 
-	_textEditWidget = new TextEditWidget(_vm, textEditX, textEditY, this, 29,
-		_fontSurface, textEditBackgroundFileHash, textEditRect);
+	_textEditWidget = new TextEditWidget(_vm, UPSCALE(textEditX, textEditY), this, 29,
+		_fontSurface, textEditBackgroundFileHash, upscaleRect(textEditRect));
 	if (isSave)
-		_textEditWidget->setCursor(textEditCursorFileHash, 2, 13);
+		_textEditWidget->setCursor(textEditCursorFileHash, UPSCALE(2, 13));
 	else
 		_textEditWidget->setReadOnly(true);
 	_textEditWidget->initialize();
@@ -967,7 +972,7 @@ GameStateMenu::GameStateMenu(NeverhoodEngine *vm, Module *parentModule, Savegame
 
 	for (uint buttonIndex = 0; buttonIndex < 6; ++buttonIndex) {
 		Sprite *menuButton = insertSprite<MenuButton>(this, buttonIndex,
-			buttonFileHashes[buttonIndex], buttonCollisionBounds[buttonIndex]);
+			buttonFileHashes[buttonIndex], upscaleRect(buttonCollisionBounds[buttonIndex]));
 		addCollisionSprite(menuButton);
 	}
 
@@ -1197,7 +1202,7 @@ QueryOverwriteMenu::QueryOverwriteMenu(NeverhoodEngine *vm, Module *parentModule
 
 	for (uint buttonIndex = 0; buttonIndex < 2; ++buttonIndex) {
 		Sprite *menuButton = insertSprite<MenuButton>(this, buttonIndex,
-			kQueryOverwriteMenuButtonFileHashes[buttonIndex], kQueryOverwriteMenuCollisionBounds[buttonIndex]);
+			kQueryOverwriteMenuButtonFileHashes[buttonIndex], upscaleRect(kQueryOverwriteMenuCollisionBounds[buttonIndex]));
 		addCollisionSprite(menuButton);
 	}
 
@@ -1208,9 +1213,11 @@ QueryOverwriteMenu::QueryOverwriteMenu(NeverhoodEngine *vm, Module *parentModule
 	textLines.push_back(description);
 	textLines.push_back("Game exists.");
 	textLines.push_back("Overwrite it?");
-	for (uint i = 0; i < textLines.size(); ++i)
-		fontSurface->drawString(_background->getSurface(), 106 + (423 - textLines[i].size() * 11) / 2,
-			127 + 31 + i * 17, (const byte*)textLines[i].c_str());
+	for (uint i = 0; i < textLines.size(); ++i) {
+		const NCoord textWidth = fontSurface->getStringWidth((const byte*)textLines[i].c_str(), textLines[i].size());
+		fontSurface->drawString(_background->getSurface(), UPSCALE_X(106) + (UPSCALE_X(423) - textWidth) / 2,
+			UPSCALE_Y(127 + 31 + i * 17), (const byte*)textLines[i].c_str());
+	}
 	delete fontSurface;
 
 	SetUpdateHandler(&Scene::update);
@@ -24,9 +24,10 @@
 
 namespace Neverhood {
 
-MicroTileArray::MicroTileArray(int16 width, int16 height) {
-	_tilesW = (width / TileSize) + ((width % TileSize) > 0 ? 1 : 0);
-	_tilesH = (height / TileSize) + ((height % TileSize) > 0 ? 1 : 0);
+MicroTileArray::MicroTileArray(NCoord width, NCoord height) : _width(width), _height(height) {
+	_tileSize = MIN(UPSCALE_X(32), 256);
+	_tilesW = (width / _tileSize) + ((width % _tileSize) > 0 ? 1 : 0);
+	_tilesH = (height / _tileSize) + ((height % _tileSize) > 0 ? 1 : 0);
 	_tiles = new BoundingBox[_tilesW * _tilesH];
 	clear();
 }
@@ -35,30 +36,30 @@ MicroTileArray::~MicroTileArray() {
 	delete[] _tiles;
 }
 
-void MicroTileArray::addRect(Common::Rect r) {
+void MicroTileArray::addRect(NRect r) {
 
 	int ux0, uy0, ux1, uy1;
 	int tx0, ty0, tx1, ty1;
 	int ix0, iy0, ix1, iy1;
 
-	r.clip(Common::Rect(0, 0, UPSCALE_X(640) - 1, UPSCALE_Y(480) - 1));
+	r.clip(NRect::make(0, 0, _width - 1, _height - 1));
 
-	ux0 = r.left / TileSize;
-	uy0 = r.top / TileSize;
-	ux1 = r.right / TileSize;
-	uy1 = r.bottom / TileSize;
+	ux0 = r.x1 / _tileSize;
+	uy0 = r.y1 / _tileSize;
+	ux1 = r.x2 / _tileSize;
+	uy1 = r.y2 / _tileSize;
 
-	tx0 = r.left % TileSize;
-	ty0 = r.top % TileSize;
-	tx1 = r.right % TileSize;
-	ty1 = r.bottom % TileSize;
+	tx0 = r.x1 % _tileSize;
+	ty0 = r.y1 % _tileSize;
+	tx1 = r.x2 % _tileSize;
+	ty1 = r.y2 % _tileSize;
 
 	for (int yc = uy0; yc <= uy1; yc++) {
 		for (int xc = ux0; xc <= ux1; xc++) {
 			ix0 = (xc == ux0) ? tx0 : 0;
-			ix1 = (xc == ux1) ? tx1 : TileSize - 1;
+			ix1 = (xc == ux1) ? tx1 : _tileSize - 1;
 			iy0 = (yc == uy0) ? ty0 : 0;
-			iy1 = (yc == uy1) ? ty1 : TileSize - 1;
+			iy1 = (yc == uy1) ? ty1 : _tileSize - 1;
 			updateBoundingBox(_tiles[xc + yc * _tilesW], ix0, iy0, ix1, iy1);
 		}
 	}
@@ -125,11 +126,11 @@ RectangleList *MicroTileArray::getRectangles() {
 				continue;
 			}
 
-			x0 = (x * TileSize) + TileX0(boundingBox);
-			y0 = (y * TileSize) + TileY0(boundingBox);
-			y1 = (y * TileSize) + TileY1(boundingBox);
+			x0 = (x * _tileSize) + TileX0(boundingBox);
+			y0 = (y * _tileSize) + TileY0(boundingBox);
+			y1 = (y * _tileSize) + TileY1(boundingBox);
 
-			if (TileX1(boundingBox) == TileSize - 1 && x != _tilesW - 1) {	// check if the tile continues
+			if (TileX1(boundingBox) == _tileSize - 1 && x != _tilesW - 1) {	// check if the tile continues
 				while (!finish) {
 					++x;
 					++i;
@@ -145,9 +146,9 @@ RectangleList *MicroTileArray::getRectangles() {
 				}
 			}
 
-			x1 = (x * TileSize) + TileX1(_tiles[i]);
+			x1 = (x * _tileSize) + TileX1(_tiles[i]);
 
-			rects->push_back(Common::Rect(x0, y0, x1 + 1, y1 + 1));
+			rects->push_back(NRect::make(x0, y0, x1 + 1, y1 + 1));
 
 			++i;
 		}
@@ -25,8 +25,8 @@
 #include "common/scummsys.h"
 #include "common/list.h"
 #include "common/util.h"
-#include "common/rect.h"
-#include "neverhood.h"
+#include "neverhood/neverhood.h"
+#include "neverhood/geometry.h"
 
 namespace Neverhood {
 
@@ -34,20 +34,22 @@ typedef uint32 BoundingBox;
 
 const BoundingBox FullBoundingBox  = 0x00001F1F;
 const BoundingBox EmptyBoundingBox = 0x00000000;
-const int TileSize = UPSCALE_X(32);
 
-typedef Common::List<Common::Rect> RectangleList;
+typedef Common::List<NRect> RectangleList;
 
 class MicroTileArray {
 public:
-	MicroTileArray(int16 width, int16 height);
+	MicroTileArray(NCoord width, NCoord height);
 	~MicroTileArray();
-	void addRect(Common::Rect r);
+	void addRect(NRect r);
 	void clear();
 	RectangleList *getRectangles();
 protected:
 	BoundingBox *_tiles;
-	int16 _tilesW, _tilesH;
+	NCoord _width, _height;
+	// Tile coordinates are stored as bytes in a BoundingBox
+	int _tileSize;
+	int _tilesW, _tilesH;
 	byte TileX0(const BoundingBox &boundingBox);
 	byte TileY0(const BoundingBox &boundingBox);
 	byte TileX1(const BoundingBox &boundingBox);
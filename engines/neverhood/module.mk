@@ -61,11 +61,13 @@ MODULE_OBJS = \
 	resourceman.o \
 	saveload.o \
 	scene.o \
+	scenearena.o \
 	screen.o \
 	smackerscene.o \
 	smackerplayer.o \
 	sound.o \
 	sprite.o \
+	surfacepool.o \
 	staticdata.o
 
 # This module can be built as a plugin
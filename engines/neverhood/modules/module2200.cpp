@@ -1437,20 +1437,20 @@ void Scene2208::drawRow(int16 rowIndex) {
 		sourceRect.y = y;
 		sourceRect.width = UPSCALE_X(640);
 		sourceRect.height = UPSCALE_Y(48);
-		_background->getSurface()->copyFrom(_topBackgroundSurface->getSurface(), UPSCALE_X(0), y, sourceRect);
+		_background->getSurface()->copyFrom(_topBackgroundSurface->getPixelSurface(), UPSCALE_X(0), y, sourceRect);
 	} else if (rowIndex > _maxRowIndex - 5) {
 		sourceRect.x = UPSCALE_X(0);
 		sourceRect.y = UPSCALE_Y((rowIndex - _maxRowIndex + 4) * 48);
 		sourceRect.width = UPSCALE_X(640);
 		sourceRect.height = UPSCALE_Y(48);
-		_background->getSurface()->copyFrom(_bottomBackgroundSurface->getSurface(), UPSCALE_X(0), y, sourceRect);
+		_background->getSurface()->copyFrom(_bottomBackgroundSurface->getPixelSurface(), UPSCALE_X(0), y, sourceRect);
 	} else {
 		rowIndex -= 4;
 		sourceRect.x = UPSCALE_X(0);
 		sourceRect.y = UPSCALE_Y((rowIndex * 48) % 480);
 		sourceRect.width = UPSCALE_X(640);
 		sourceRect.height = UPSCALE_Y(48);
-		_background->getSurface()->copyFrom(_backgroundSurface->getSurface(), UPSCALE_X(0), y, sourceRect);
+		_background->getSurface()->copyFrom(_backgroundSurface->getPixelSurface(), UPSCALE_X(0), y, sourceRect);
 		if (rowIndex < (int)_strings.size()) {
 			const char *text = _strings[rowIndex];
 			_fontSurface->drawString(_background->getSurface(), UPSCALE_X(95), y, (const byte*)text);
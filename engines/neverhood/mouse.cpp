@@ -26,7 +26,7 @@ namespace Neverhood {
 
 Mouse::Mouse(NeverhoodEngine *vm, uint32 fileHash, const NRect &mouseRect)
 	: StaticSprite(vm, 2000), _mouseType(kMouseType433),
-	_mouseCursorResource(vm), _frameNum(0) {
+	_mouseCursorResource(vm), _frameNum(0), _uploadedFileHash(0), _uploadedCursorNum(-1), _uploadedFrameNum(-1) {
 
 	_mouseRect = mouseRect;
 	init(fileHash);
@@ -41,7 +41,8 @@ Mouse::Mouse(NeverhoodEngine *vm, uint32 fileHash, const NRect &mouseRect)
 
 Mouse::Mouse(NeverhoodEngine *vm, uint32 fileHash, int16 x1, int16 x2)
 	: StaticSprite(vm, 2000), _mouseType(kMouseType435),
-	_mouseCursorResource(vm), _frameNum(0), _x1(x1), _x2(x2) {
+	_mouseCursorResource(vm), _frameNum(0), _x1(x1), _x2(x2),
+	_uploadedFileHash(0), _uploadedCursorNum(-1), _uploadedFrameNum(-1) {
 
 	init(fileHash);
 	if (_x <= _x1) {
@@ -56,7 +57,8 @@ Mouse::Mouse(NeverhoodEngine *vm, uint32 fileHash, int16 x1, int16 x2)
 
 Mouse::Mouse(NeverhoodEngine *vm, uint32 fileHash, int type)
 	: StaticSprite(vm, 2000), _mouseType(kMouseTypeNavigation),
-	_mouseCursorResource(vm), _type(type), _frameNum(0) {
+	_mouseCursorResource(vm), _type(type), _frameNum(0),
+	_uploadedFileHash(0), _uploadedCursorNum(-1), _uploadedFrameNum(-1) {
 
 	init(fileHash);
 	_mouseCursorResource.setCursorNum(0);
@@ -92,6 +94,7 @@ void Mouse::update() {
 	if (CursorMan.isVisible() && !_surface->getVisible()) {
 		CursorMan.showMouse(false);
 	} else if (!CursorMan.isVisible() && _surface->getVisible()) {
+		_needRefresh = true;
 		CursorMan.showMouse(true);
 	}
 	updateCursor();
@@ -182,11 +185,22 @@ void Mouse::updateCursor() {
 	if (_needRefresh) {
 		_needRefresh = false;
 		_drawOffset = _mouseCursorResource.getRect();
-		_surface->drawMouseCursorResource(_mouseCursorResource, _frameNum / 2);
-		Graphics::Surface *cursorSurface = _surface->getSurface();
-		Graphics::PixelFormat format = Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
-		CursorMan.replaceCursor((const byte*)cursorSurface->getPixels(),
-			cursorSurface->w, cursorSurface->h, -_drawOffset.x, -_drawOffset.y, 0, false, &format);
+		// The cursor is overlaid by the backend, only upload it again when
+		// the visible frame actually changed
+		const uint32 fileHash = _mouseCursorResource.getFileHash();
+		const int cursorNum = _mouseCursorResource.getCursorNum();
+		const int frameNum = _frameNum / 2;
+		if (_surface->getVisible() && (fileHash != _uploadedFileHash ||
+			cursorNum != _uploadedCursorNum || frameNum != _uploadedFrameNum)) {
+			_surface->drawMouseCursorResource(_mouseCursorResource, frameNum);
+			Graphics::Surface *cursorSurface = _surface->getPixelSurface();
+			Graphics::PixelFormat format = Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
+			CursorMan.replaceCursor((const byte*)cursorSurface->getPixels(),
+				cursorSurface->w, cursorSurface->h, -_drawOffset.x, -_drawOffset.y, 0, false, &format);
+			_uploadedFileHash = fileHash;
+			_uploadedCursorNum = cursorNum;
+			_uploadedFrameNum = frameNum;
+		}
 	}
 
 }
@@ -53,6 +53,10 @@ protected:
 	int16 _x1;
 	int16 _x2;
 	int _type;
+	// Last cursor frame uploaded to the backend
+	uint32 _uploadedFileHash;
+	int _uploadedCursorNum;
+	int _uploadedFrameNum;
 	void init(uint32 fileHash);
 	void update();
 	void updateCursorNum();
@@ -49,6 +49,8 @@ namespace Neverhood {
 
 ConfigData* ConfigData::_singleton = nullptr;
 
+ScaleTransform NeverhoodEngine::_scale;
+
 NeverhoodEngine::NeverhoodEngine(OSystem *syst, const ADGameDescription *gameDesc) :
 		Engine(syst), _gameDescription(gameDesc) {
 	// Setup mixer
@@ -69,13 +71,14 @@ NeverhoodEngine::~NeverhoodEngine() {
 }
 
 Common::Error NeverhoodEngine::run() {
-	initGraphics(UPSCALE(640, 480));
-
 	const Common::FSNode gameDataDir(ConfMan.get("path"));
 
 	SearchMan.addSubDirectoryMatching(gameDataDir, "data");
 
 	ConfigData::get()->load(gameDataDir.getPath() + "neverhood.ini");
+	_scale.set(ConfigData::get()->upscaleDividend, ConfigData::get()->upscaleDivisor);
+
+	initGraphics(UPSCALE(640, 480));
 
 	_isSaveAllowed = false;
 
@@ -200,7 +203,9 @@ void NeverhoodEngine::mainLoop() {
 		_audioResourceMan->updateMusic();
 
 		_system->updateScreen();
-		_system->delayMillis(10);
+		// Wake up in time for the next video frame instead of a fixed 10 ms
+		const uint32 currTime = _system->getMillis();
+		_system->delayMillis(nextFrameTime > currTime ? CLIP<uint32>(nextFrameTime - currTime, 1, 10) : 1);
 	}
 }
 
@@ -240,12 +245,10 @@ void ConfigData::load(const Common::String& filename) {
 
 
 void ConfigData::save(const Common::String &filename) {
-	char temp[16] = {};
-
 	Common::INIFile inifile;
 	inifile.addSection(section);
-	inifile.setKey("upscaleDividend", section, itoa(upscaleDividend, temp, 10));
-	inifile.setKey("upscaleDivisor", section, itoa(upscaleDivisor, temp, 10));
+	inifile.setKey("upscaleDividend", section, Common::String::format("%d", upscaleDividend));
+	inifile.setKey("upscaleDivisor", section, Common::String::format("%d", upscaleDivisor));
 	inifile.setKey("isLooseData", section, isLooseData ? "1" : "0");
 	inifile.setKey("looseDataFolder", section, looseDataFolder);
 
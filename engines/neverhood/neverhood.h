@@ -33,13 +33,14 @@
 #include "gui/debugger.h"
 #include "neverhood/console.h"
 #include "neverhood/messages.h"
+#include "neverhood/scale.h"
 
-#define UPSCALE_X(x) ((int16)(x) * ConfigData::get()->upscaleDividend / ConfigData::get()->upscaleDivisor)
-#define UPSCALE_Y(y) ((int16)(y) * ConfigData::get()->upscaleDividend / ConfigData::get()->upscaleDivisor)
+#define UPSCALE_X(x) (Neverhood::NeverhoodEngine::_scale.up((int32)(x)))
+#define UPSCALE_Y(y) (Neverhood::NeverhoodEngine::_scale.up((int32)(y)))
 #define UPSCALE(x, y) UPSCALE_X(x), UPSCALE_Y(y)
 
-#define DOWNSCALE_X(x) ((int16)(x)*ConfigData::get()->upscaleDivisor / ConfigData::get()->upscaleDividend)
-#define DOWNSCALE_Y(y) ((int16)(y)*ConfigData::get()->upscaleDivisor / ConfigData::get()->upscaleDividend)
+#define DOWNSCALE_X(x) (Neverhood::NeverhoodEngine::_scale.down((int32)(x)))
+#define DOWNSCALE_Y(y) (Neverhood::NeverhoodEngine::_scale.down((int32)(y)))
 #define DOWNSCALE(x, y) DOWNSCALE_X(x), DOWNSCALE_Y(y)
 
 #define DBG_HEX 0xDB9
@@ -81,6 +82,7 @@ public:
 
 	static void free() {
 		delete _singleton;
+		_singleton = nullptr;
 	}
 
 private:
@@ -123,6 +125,11 @@ public:
 	SoundMan *_soundMan;
 	AudioResourceMan *_audioResourceMan;
 
+	// Used by the UPSCALE/DOWNSCALE macros. Static so that the constant
+	// tables in the modules can use it, it defaults to the 9/2 ratio until
+	// the configuration has been loaded.
+	static ScaleTransform _scale;
+
 public:
 
 	/* Save/load */
@@ -21,6 +21,7 @@
 
 #include "common/algorithm.h"
 #include "common/memstream.h"
+#include "common/span.h"
 #include "neverhood/resource.h"
 #include "neverhood/resourceman.h"
 
@@ -134,13 +135,18 @@ void AnimResource::draw(uint frameIndex, Graphics::Surface *destSurface, bool fl
 	const AnimFrameInfo frameInfo = _frames[frameIndex];
 	byte *dest = (byte *)destSurface->getPixels();
 	const int destPitch = destSurface->pitch;
-	_currSpriteData = _spriteData + frameInfo.spriteDataOffs;
 	_width = frameInfo.drawOffset.width;
 	_height = frameInfo.drawOffset.height;
 
-	if (_resourceHandle.upscaledData(frameIndex))
-		unpackSpriteUpscaled(_currSpriteData, _width, _height, dest, destPitch, flipX, flipY, destSurface->GetRgbOffset());
-	else if (_replEnabled && _replOldColor != _replNewColor)
+	if (_resourceHandle.hasUpscaledData()) {
+		_currSpriteData = _vm->_res->getUpscaledFrame(_resourceHandle, frameIndex);
+		if (_currSpriteData)
+			unpackSpriteUpscaled(_currSpriteData, _width, _height, dest, destPitch, flipX, flipY, destSurface->GetRgbOffset());
+		return;
+	}
+
+	_currSpriteData = _spriteData + frameInfo.spriteDataOffs;
+	if (_replEnabled && _replOldColor != _replNewColor)
 		unpackSpriteRle(_currSpriteData, _width, _height, dest, destPitch, flipX, flipY, _replOldColor, _replNewColor);
 	else
 		unpackSpriteRle(_currSpriteData, _width, _height, dest, destPitch, flipX, flipY);
@@ -222,7 +228,7 @@ bool AnimResource::load(uint32 fileHash) {
 			frameInfo.spriteDataOffs);
 		frameList += 32;
 
-		if (_resourceHandle.upscaledData(0)) {
+		if (_resourceHandle.hasUpscaledData()) {
 			frameInfo.drawOffset.x = UPSCALE_X(frameInfo.drawOffset.x);
 			frameInfo.drawOffset.y = UPSCALE_Y(frameInfo.drawOffset.y);
 			frameInfo.drawOffset.width = _resourceHandle.upscaledDataWidth(frameIndex);
@@ -233,7 +239,6 @@ bool AnimResource::load(uint32 fileHash) {
 			frameInfo.collisionBoundsOffset.y = UPSCALE_Y(frameInfo.collisionBoundsOffset.y);
 			frameInfo.collisionBoundsOffset.width = UPSCALE_X(frameInfo.collisionBoundsOffset.width);
 			frameInfo.collisionBoundsOffset.height = UPSCALE_Y(frameInfo.collisionBoundsOffset.height);
-			frameInfo.spriteDataOffs = _resourceHandle.upscaledData(frameIndex) - _spriteData; // TODO: 64 bit @@SB
 		}
 
 		_frames.push_back(frameInfo);
@@ -339,7 +344,7 @@ void MouseCursorResource::draw(int frameNum, Graphics::Surface *destSurface) {
 		int bytesPerPixel = 4;
 		const int sourcePitch =  ((_cursorSprite.getDimensions().width + 3) & 0xFFFC) * bytesPerPixel; // 4 byte alignment
 		const int destPitch = destSurface->pitch;
-		const byte *source = _cursorSprite.getPixels() + _cursorNum * (sourcePitch * UPSCALE_Y(32)) + frameNum * bytesPerPixel * UPSCALE_X(32);
+		const byte *source = _cursorSprite.getPixels() + calcPixelOffset(frameNum * UPSCALE_X(32), _cursorNum * UPSCALE_Y(32), sourcePitch, bytesPerPixel);
 		byte *dest = (byte*)destSurface->getPixels();
 		for (int16 yc = 0; yc < UPSCALE_Y(32); yc++) {
 			memcpy(dest, source, bytesPerPixel * UPSCALE_X(32));
@@ -393,6 +398,30 @@ DataResource::~DataResource() {
 	unload();
 }
 
+// Of a truncated list, only the whole records are kept
+static uint clipRecordCount(Common::MemoryReadStream &stream, uint count, uint recordSize) {
+	const uint available = (stream.size() - stream.pos()) / recordSize;
+	if (count > available) {
+		warning("DataResource: %d records of %d bytes exceed the resource, keeping %d", count, recordSize, available);
+		count = available;
+	}
+	return count;
+}
+
+// Returns a view of the next count records
+static Common::Span<const byte> readRecords(Common::MemoryReadStream &stream, uint count, uint recordSize) {
+	return Common::readSpan(stream, clipRecordCount(stream, count, recordSize) * recordSize);
+}
+
+// Reads the next count records made of valuesPerRecord 16-bit values, and
+// returns the number of records read
+static uint readUint16Records(Common::MemoryReadStream &stream, uint count, uint valuesPerRecord, Common::Array<uint16> &values) {
+	count = clipRecordCount(stream, count, valuesPerRecord * 2);
+	values.resize(count * valuesPerRecord);
+	stream.readUint16LEArray(values.begin(), count * valuesPerRecord);
+	return count;
+}
+
 void DataResource::load(uint32 fileHash) {
 	if (_resourceHandle.fileHash() == fileHash)
 		return;
@@ -408,25 +437,34 @@ void DataResource::load(uint32 fileHash) {
 	}
 	if (data && dataSize) {
 		_fileHash = fileHash;
+		// The records are read in one go, through bounds checked views of the
+		// resource data or arrays of values, instead of one stream read per
+		// field
 		Common::MemoryReadStream dataS(data, dataSize);
+		Common::Array<uint16> values16;
+		Common::Array<uint32> values32;
 		uint itemCount = dataS.readUint16LE();
 		uint32 itemStartOffs = 2 + itemCount * 8;
+		Common::Span<const byte> directory = readRecords(dataS, itemCount, 8);
+		itemCount = directory.size() / 8;
 		debug(2, "itemCount = %d", itemCount);
 		for (uint i = 0; i < itemCount; i++) {
-			dataS.seek(2 + i * 8);
 			DRDirectoryItem drDirectoryItem;
-			drDirectoryItem.nameHash = dataS.readUint32LE();
-			drDirectoryItem.offset = dataS.readUint16LE();
-			drDirectoryItem.type = dataS.readUint16LE();
+			drDirectoryItem.nameHash = directory.getUint32LEAt(i * 8);
+			drDirectoryItem.offset = directory.getUint16LEAt(i * 8 + 4);
+			drDirectoryItem.type = directory.getUint16LEAt(i * 8 + 6);
 			debug(2, "%03d nameHash = %08X; offset = %04X; type = %d", i, drDirectoryItem.nameHash, drDirectoryItem.offset, drDirectoryItem.type);
 			dataS.seek(itemStartOffs + drDirectoryItem.offset);
 			switch (drDirectoryItem.type) {
 			case 1:
 				{
 					debug(3, "NPoint");
-					NPoint point;
-					point.x = UPSCALE_X(dataS.readUint16LE());
-					point.y = UPSCALE_Y(dataS.readUint16LE());
+					Common::Span<const byte> record = readRecords(dataS, 1, 4);
+					NPoint point = NPoint();
+					if (record) {
+						point.x = UPSCALE_X(record.getUint16LEAt(0));
+						point.y = UPSCALE_Y(record.getUint16LEAt(2));
+					}
 					debug(3, "(%d, %d)", point.x, point.y);
 					drDirectoryItem.offset = _points.size();
 					_points.push_back(point);
@@ -434,13 +472,14 @@ void DataResource::load(uint32 fileHash) {
 				}
 			case 2:
 				{
-					uint count = dataS.readUint16LE();
+					const uint count = readUint16Records(dataS, dataS.readUint16LE(), 2, values16);
 					NPointArray *pointArray = new NPointArray();
+					pointArray->reserve(count);
 					debug(3, "NPointArray; count = %d", count);
 					for (uint j = 0; j < count; j++) {
 						NPoint point;
-						point.x = UPSCALE_X(dataS.readUint16LE());
-						point.y = UPSCALE_Y(dataS.readUint16LE());
+						point.x = UPSCALE_X(values16[j * 2]);
+						point.y = UPSCALE_Y(values16[j * 2 + 1]);
 						debug(3, "(%d, %d)", point.x, point.y);
 						pointArray->push_back(point);
 					}
@@ -450,16 +489,17 @@ void DataResource::load(uint32 fileHash) {
 				}
 			case 3:
 				{
-					uint count = dataS.readUint16LE();
+					const uint count = readUint16Records(dataS, dataS.readUint16LE(), 5, values16);
 					HitRectList *hitRectList = new HitRectList();
+					hitRectList->reserve(count);
 					debug(3, "HitRectList; count = %d", count);
 					for (uint j = 0; j < count; j++) {
 						HitRect hitRect;
-						hitRect.rect.x1 = UPSCALE_X(dataS.readUint16LE());
-						hitRect.rect.y1 = UPSCALE_Y(dataS.readUint16LE());
-						hitRect.rect.x2 = UPSCALE_X(dataS.readUint16LE());
-						hitRect.rect.y2 = UPSCALE_Y(dataS.readUint16LE());
-						hitRect.type = dataS.readUint16LE() + 0x5001;
+						hitRect.rect.x1 = UPSCALE_X(values16[j * 5]);
+						hitRect.rect.y1 = UPSCALE_Y(values16[j * 5 + 1]);
+						hitRect.rect.x2 = UPSCALE_X(values16[j * 5 + 2]);
+						hitRect.rect.y2 = UPSCALE_Y(values16[j * 5 + 3]);
+						hitRect.type = values16[j * 5 + 4] + 0x5001;
 						debug(3, "(%d, %d, %d, %d) -> %04d", hitRect.rect.x1, hitRect.rect.y1, hitRect.rect.x2, hitRect.rect.y2, hitRect.type);
 						hitRectList->push_back(hitRect);
 					}
@@ -469,13 +509,16 @@ void DataResource::load(uint32 fileHash) {
 				}
 			case 4:
 				{
-					uint count = dataS.readUint16LE();
+					const uint count = clipRecordCount(dataS, dataS.readUint16LE(), 8);
+					values32.resize(count * 2);
+					dataS.readUint32LEArray(values32.begin(), count * 2);
 					MessageList *messageList = new MessageList();
+					messageList->reserve(count);
 					debug(3, "MessageList; count = %d", count);
 					for (uint j = 0; j < count; j++) {
 						MessageItem messageItem;
-						messageItem.messageNum = dataS.readUint32LE();
-						messageItem.messageValue = dataS.readUint32LE();
+						messageItem.messageNum = values32[j * 2];
+						messageItem.messageValue = values32[j * 2 + 1];
 						debug(3, "(%08X, %08X)", messageItem.messageNum, messageItem.messageValue);
 						messageList->push_back(messageItem);
 					}
@@ -486,16 +529,19 @@ void DataResource::load(uint32 fileHash) {
 			case 5:
 				{
 					uint count = dataS.readUint16LE();
+					Common::Span<const byte> records = readRecords(dataS, count, 14);
+					count = records.size() / 14;
 					DRSubRectList *drSubRectList = new DRSubRectList();
+					drSubRectList->reserve(count);
 					debug(3, "SubRectList; count = %d", count);
 					for (uint j = 0; j < count; j++) {
 						DRSubRect drSubRect;
-						drSubRect.rect.x1 = UPSCALE_X(dataS.readUint16LE());
-						drSubRect.rect.y1 = UPSCALE_Y(dataS.readUint16LE());
-						drSubRect.rect.x2 = UPSCALE_X(dataS.readUint16LE());
-						drSubRect.rect.y2 = UPSCALE_Y(dataS.readUint16LE());
-						drSubRect.messageListHash = dataS.readUint32LE();
-						drSubRect.messageListItemIndex = dataS.readUint16LE();
+						drSubRect.rect.x1 = UPSCALE_X(records.getUint16LEAt(j * 14));
+						drSubRect.rect.y1 = UPSCALE_Y(records.getUint16LEAt(j * 14 + 2));
+						drSubRect.rect.x2 = UPSCALE_X(records.getUint16LEAt(j * 14 + 4));
+						drSubRect.rect.y2 = UPSCALE_Y(records.getUint16LEAt(j * 14 + 6));
+						drSubRect.messageListHash = records.getUint32LEAt(j * 14 + 8);
+						drSubRect.messageListItemIndex = records.getUint16LEAt(j * 14 + 12);
 						debug(3, "(%d, %d, %d, %d) -> %08X (%d)", drSubRect.rect.x1, drSubRect.rect.y1, drSubRect.rect.x2, drSubRect.rect.y2, drSubRect.messageListHash, drSubRect.messageListItemIndex);
 						drSubRectList->push_back(drSubRect);
 					}
@@ -505,12 +551,15 @@ void DataResource::load(uint32 fileHash) {
 				}
 			case 6:
 				{
-					DRRect drRect;
-					drRect.rect.x1 = UPSCALE_X(dataS.readUint16LE());
-					drRect.rect.y1 = UPSCALE_Y(dataS.readUint16LE());
-					drRect.rect.x2 = UPSCALE_X(dataS.readUint16LE());
-					drRect.rect.y2 = UPSCALE_Y(dataS.readUint16LE());
-					drRect.subRectIndex = dataS.readUint16LE();
+					Common::Span<const byte> record = readRecords(dataS, 1, 10);
+					DRRect drRect = DRRect();
+					if (record) {
+						drRect.rect.x1 = UPSCALE_X(record.getUint16LEAt(0));
+						drRect.rect.y1 = UPSCALE_Y(record.getUint16LEAt(2));
+						drRect.rect.x2 = UPSCALE_X(record.getUint16LEAt(4));
+						drRect.rect.y2 = UPSCALE_Y(record.getUint16LEAt(6));
+						drRect.subRectIndex = record.getUint16LEAt(8);
+					}
 					debug(3, "(%d, %d, %d, %d) -> %d", drRect.rect.x1, drRect.rect.y1, drRect.rect.x2, drRect.rect.y2, drRect.subRectIndex);
 					drDirectoryItem.offset = _drRects.size();
 					_drRects.push_back(drRect);
@@ -518,15 +567,16 @@ void DataResource::load(uint32 fileHash) {
 				}
 			case 7:
 				{
-					uint count = dataS.readUint16LE();
+					const uint count = readUint16Records(dataS, dataS.readUint16LE(), 4, values16);
 					NRectArray *rectArray = new NRectArray();
+					rectArray->reserve(count);
 					debug(3, "NRectArray; count = %d", count);
 					for (uint j = 0; j < count; j++) {
 						NRect rect;
-						rect.x1 = UPSCALE_X(dataS.readUint16LE());
-						rect.y1 = UPSCALE_Y(dataS.readUint16LE());
-						rect.x2 = UPSCALE_X(dataS.readUint16LE());
-						rect.y2 = UPSCALE_Y(dataS.readUint16LE());
+						rect.x1 = UPSCALE_X(values16[j * 4]);
+						rect.y1 = UPSCALE_Y(values16[j * 4 + 1]);
+						rect.x2 = UPSCALE_X(values16[j * 4 + 2]);
+						rect.y2 = UPSCALE_Y(values16[j * 4 + 3]);
 						debug(3, "(%d, %d, %d, %d)", rect.x1, rect.y1, rect.x2, rect.y2);
 						rectArray->push_back(rect);
 					}
@@ -21,7 +21,10 @@
 
 #include "neverhood/resourceman.h"
 #include "image/png.h"
+#include "image/qoi.h"
 #include "common/str.h"
+#include "common/system.h"
+#include "common/timer.h"
 
 namespace Neverhood {
 
@@ -33,9 +36,14 @@ ResourceHandle::~ResourceHandle() {
 }
 
 ResourceMan::ResourceMan() {
+	g_system->getTimerManager()->installTimerProc(&upscaledFrameTimerProc, 10000, this, "NeverhoodUpscaledFrames");
 }
 
 ResourceMan::~ResourceMan() {
+	g_system->getTimerManager()->removeTimerProc(&upscaledFrameTimerProc);
+	for (Common::List<ResourceHandle::UpscaledData*>::iterator it = _upscaledQueue.begin(); it != _upscaledQueue.end(); ++it)
+		if ((*it)->unloaded)
+			delete *it;
 }
 
 void ResourceMan::addArchive(const Common::String &filename) {
@@ -159,59 +167,162 @@ void ResourceMan::loadResource(ResourceHandle &resourceHandle, bool applyResourc
 }
 
 
-void ResourceMan::loadUpscaledResource(ResourceHandle &resourceHandle, uint32 fileHash, bool isAnimation) {
-	unloadUpscaledResource(resourceHandle);
+namespace {
 
-	Common::Array<Common::String> fnames;
-	Common::String folder = ConfigData::get()->looseDataFolder + "/images";
-	Common::String fname = Common::String::format("%08X", fileHash);
+// Upscaled images are decoded straight into the memory owned by UpscaledData
+class UpscaledDataBuffer : public Image::PNGDecoder::OutputBuffer {
+public:
+	byte *allocate(uint16 width, uint16 height, uint32 pitch) override {
+		return (byte *)malloc(pitch * height);
+	}
+};
 
-	if (!isAnimation) {
-		Common::File file;
+} // End of anonymous namespace
+
+Common::ArchiveMemberPtr ResourceMan::findUpscaledImage(const Common::String &baseName) {
+	// QOI decodes several times faster than PNG, prefer it when both exist
+	if (SearchMan.hasFile(baseName + ".qoi"))
+		return SearchMan.getMember(baseName + ".qoi");
+	if (SearchMan.hasFile(baseName + ".png"))
+		return SearchMan.getMember(baseName + ".png");
+	return Common::ArchiveMemberPtr();
+}
+
+bool ResourceMan::readUpscaledImageSize(Common::SeekableReadStream &stream, int32 &width, int32 &height) {
+	// Both formats store the dimensions as big endian 32-bit values, QOI right
+	// after the magic and PNG in the IHDR chunk, which must come first
+	const bool isQOI = stream.readUint32BE() == MKTAG('q', 'o', 'i', 'f');
+	stream.seek(isQOI ? 4 : 16);
+	const uint32 imageWidth = stream.readUint32BE();
+	const uint32 imageHeight = stream.readUint32BE();
+	if (stream.err() || imageWidth == 0 || imageHeight == 0 || imageWidth > 0x7FFFFFFF || imageHeight > 0x7FFFFFFF)
+		return false;
+	width = imageWidth;
+	height = imageHeight;
+	return true;
+}
+
+bool ResourceMan::decodeUpscaledImage(Common::SeekableReadStream &stream, ResourceHandle::UpscaledData *upscaledData) {
+	const bool isQOI = stream.readUint32BE() == MKTAG('q', 'o', 'i', 'f');
+	stream.seek(0);
 
-		fname = Common::String::format("%s/%s.png", folder.c_str(), fname.c_str());
-		if (file.exists(fname)) {
-			fnames.push_back(fname);
+	if (isQOI) {
+		Image::QOIDecoder decoder;
+		if (decoder.loadStream(stream)) {
+			upscaledData->setPixels(const_cast<Graphics::Surface *>(decoder.getSurface()));
+			return true;
 		}
 	} else {
-		Common::File file;
+		Image::PNGDecoder decoder;
+		UpscaledDataBuffer outputBuffer;
+		Graphics::Surface surface;
+		if (decoder.loadStreamInto(stream, surface, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24), 4, outputBuffer)) {
+			upscaledData->setPixels(&surface);
+			return true;
+		}
+		free(surface.getPixels());
+	}
 
-		int index = 0;
-		while (true) 
-		{
-			Common::String index_fname = Common::String::format("%s/%s-%03d.png", folder.c_str(), fname.c_str(), index);
-			index++;
+	return false;
+}
 
-			if (file.exists(index_fname)) {
-				fnames.push_back(index_fname);
+void ResourceMan::decodeUpscaledFrame(ResourceHandle::UpscaledData *upscaledData) {
+	Common::SeekableReadStream *stream = upscaledData->member->createReadStream();
+	if (!stream || !decodeUpscaledImage(*stream, upscaledData))
+		warning("Couldn't decode %s", upscaledData->member->getName().c_str());
+	delete stream;
+	// Don't try to decode a broken frame again
+	upscaledData->member.reset();
+}
+
+void ResourceMan::loadUpscaledResource(ResourceHandle &resourceHandle, uint32 fileHash, bool isAnimation) {
+	unloadUpscaledResource(resourceHandle);
+
+	Common::String folder = ConfigData::get()->looseDataFolder + "/images";
+	Common::String fname = Common::String::format("%s/%08X", folder.c_str(), fileHash);
+
+	if (!isAnimation) {
+		// Sprites are drawn right after loading, so there is nothing to gain
+		// from decoding them in the background
+		Common::ArchiveMemberPtr member = findUpscaledImage(fname);
+		Common::SeekableReadStream *stream = member ? member->createReadStream() : nullptr;
+		if (stream) {
+			ResourceHandle::UpscaledData *upscaledData = new ResourceHandle::UpscaledData();
+			if (decodeUpscaledImage(*stream, upscaledData)) {
+				resourceHandle._upscaledData.push_back(upscaledData);
 			} else {
-				break;
+				warning("Couldn't decode %s", member->getName().c_str());
+				delete upscaledData;
 			}
+			delete stream;
+		}
+	} else {
+		// Only the frame dimensions are needed to build the frame list, the
+		// pixels are decoded in the background by decodeQueuedFrames()
+		for (int index = 0; ; index++) {
+			Common::ArchiveMemberPtr member = findUpscaledImage(Common::String::format("%s-%03d", fname.c_str(), index));
+			Common::SeekableReadStream *stream = member ? member->createReadStream() : nullptr;
+			if (!stream)
+				break;
+			ResourceHandle::UpscaledData *upscaledData = new ResourceHandle::UpscaledData();
+			if (!readUpscaledImageSize(*stream, upscaledData->width, upscaledData->height))
+				warning("Couldn't read the dimensions of %s", member->getName().c_str());
+			delete stream;
+			upscaledData->member = member;
+			resourceHandle._upscaledData.push_back(upscaledData);
+		}
+
+		Common::StackLock lock(_upscaledMutex);
+		for (uint index = 0; index < resourceHandle._upscaledData.size(); index++) {
+			resourceHandle._upscaledData[index]->queued = true;
+			_upscaledQueue.push_back(resourceHandle._upscaledData[index]);
 		}
 	}
+}
 
-	for (Common::String cur_fname : fnames) {
-		Common::File file;
-		file.open(cur_fname);
+const byte *ResourceMan::getUpscaledFrame(ResourceHandle &resourceHandle, uint index) {
+	if (index >= resourceHandle._upscaledData.size())
+		return nullptr;
+	ResourceHandle::UpscaledData *upscaledData = resourceHandle._upscaledData[index];
 
-		resourceHandle._upscaledData.reserve(fnames.size());
+	Common::StackLock lock(_upscaledMutex);
+	// The frame stays queued, decodeQueuedFrames() skips it
+	if (upscaledData->member)
+		decodeUpscaledFrame(upscaledData);
+	return upscaledData->data;
+}
 
-		Image::PNGDecoder *decoder = new Image::PNGDecoder();
-		if (decoder->loadStream(file)) {
-			resourceHandle._upscaledData.push_back(new ResourceHandle::UpscaledData(decoder));
-			delete decoder;
-		}
-		else {
-			warning("Couldn't decode ");
-			delete decoder;
-			continue;
+void ResourceMan::upscaledFrameTimerProc(void *refCon) {
+	((ResourceMan *)refCon)->decodeQueuedFrames();
+}
+
+void ResourceMan::decodeQueuedFrames() {
+	Common::StackLock lock(_upscaledMutex);
+	while (!_upscaledQueue.empty()) {
+		ResourceHandle::UpscaledData *upscaledData = _upscaledQueue.front();
+		_upscaledQueue.pop_front();
+		upscaledData->queued = false;
+		if (upscaledData->unloaded) {
+			delete upscaledData;
+		} else if (upscaledData->member) {
+			decodeUpscaledFrame(upscaledData);
+			break;
 		}
 	}
 }
 
 void ResourceMan::unloadUpscaledResource(ResourceHandle &resourceHandle) {
+	Common::StackLock lock(_upscaledMutex);
 	for (ResourceHandle::UpscaledData *data : resourceHandle._upscaledData) {
-		delete data;
+		if (data->queued) {
+			// Deleted by decodeQueuedFrames()
+			data->unloaded = true;
+			data->member.reset();
+			free(data->data);
+			data->data = nullptr;
+		} else {
+			delete data;
+		}
 	}
 	resourceHandle._upscaledData.clear();
 }
@@ -228,7 +339,7 @@ void ResourceMan::unloadResource(ResourceHandle &resourceHandle) {
 }
 
 void ResourceMan::purgeResources() {
-	for (Common::HashMap<uint32, ResourceData*>::iterator it = _data.begin(); it != _data.end(); ++it) {
+	for (DataMap::iterator it = _data.begin(); it != _data.end(); ++it) {
 		ResourceData *resourceData = (*it)._value;
 		if (resourceData->dataRefCount == 0) {
 			delete[] resourceData->data;
@@ -237,18 +348,18 @@ void ResourceMan::purgeResources() {
 	}
 }
 
- ResourceHandle::UpscaledData::UpscaledData(Image::PNGDecoder *decoder) {
-	const Graphics::Surface *surface = decoder->getSurface();
+ void ResourceHandle::UpscaledData::setPixels(Graphics::Surface *surface) {
+	free(data);
 	format = surface->format;
-	data = (const byte*)surface->getPixels();
-	const_cast<Graphics::Surface*>(surface)->setPixels(nullptr);
+	data = (byte *)surface->getPixels();
+	surface->setPixels(nullptr);
 	width = surface->w;
 	height = surface->h;
  }
 
 
  ResourceHandle::UpscaledData::~UpscaledData() {
-	 free((void*)data);
+	 free(data);
  }
 
  } // End of namespace Neverhood
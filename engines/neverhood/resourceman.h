@@ -22,12 +22,14 @@
 #ifndef NEVERHOOD_RESOURCEMAN_H
 #define NEVERHOOD_RESOURCEMAN_H
 
+#include "common/archive.h"
 #include "common/array.h"
 #include "common/file.h"
-#include "common/hashmap.h"
+#include "common/flat-hashmap.h"
+#include "common/list.h"
+#include "common/mutex.h"
 #include "neverhood/neverhood.h"
 #include "neverhood/blbarchive.h"
-#include "image/png.h"
 #include "graphics/surface.h"
 
 namespace Neverhood {
@@ -63,23 +65,31 @@ public:
 	const byte *extData() const { return _extData; };
 	uint32 fileHash() const { return isValid() ? _resourceFileEntry->archiveEntry->fileHash : 0; };
 
+	bool hasUpscaledData() const { return !_upscaledData.empty(); }
 	const byte *upscaledData(unsigned int index) const { return _upscaledData.size() > index ? _upscaledData[index]->data : 0; }
-	int16 upscaledDataWidth(unsigned int index) const { return _upscaledData.size() > index ? _upscaledData[index]->width : 0; }
-	int16 upscaledDataHeight(unsigned int index) const { return _upscaledData.size() > index ? _upscaledData[index]->height : 0; }
+	int32 upscaledDataWidth(unsigned int index) const { return _upscaledData.size() > index ? _upscaledData[index]->width : 0; }
+	int32 upscaledDataHeight(unsigned int index) const { return _upscaledData.size() > index ? _upscaledData[index]->height : 0; }
 
 	ResourceFileEntry *_resourceFileEntry;
 	const byte *_extData;
 	const byte *_data;
 
 	struct UpscaledData {
-		const byte *data = nullptr;
-		int16 width = 0;
-		int16 height = 0;
+		byte *data = nullptr;
+		int32 width = 0;
+		int32 height = 0;
 		Graphics::PixelFormat format;
+		// Set while the pixels of an animation frame are not decoded yet
+		Common::ArchiveMemberPtr member;
+		// In the decoding queue of ResourceMan, which deletes the frame when
+		// it comes up if it was unloaded in the meantime
+		bool queued = false;
+		bool unloaded = false;
 
 		UpscaledData() {};
-		UpscaledData(Image::PNGDecoder *decoder);
 		~UpscaledData();
+		// Takes ownership of the surface pixels
+		void setPixels(Graphics::Surface *surface);
 	};
 
 	Common::Array<UpscaledData*> _upscaledData;
@@ -93,21 +103,44 @@ public:
 	ResourceFileEntry *findEntrySimple(uint32 fileHash);
 	ResourceFileEntry *findEntry(uint32 fileHash, ResourceFileEntry **firstEntry = NULL);
 	Common::SeekableReadStream *createStream(uint32 fileHash);
-	const ResourceFileEntry& getEntry(uint index) { return _entries[index]; }
 	uint getEntryCount() { return _entries.size(); }
+	uint getArchiveCount() { return _archives.size(); }
+	BlbArchive *getArchive(uint index) { return _archives[index]; }
 	void queryResource(uint32 fileHash, ResourceHandle &resourceHandle);
 	void loadResource(ResourceHandle &resourceHandle, bool applyResourceFixes);
 	void loadUpscaledResource(ResourceHandle &resourceHandle, uint32 fileHash, bool isAnimation = false);
+	// Returns the pixels of an animation frame, decoding them right away if
+	// the background decoder did not get to the frame yet
+	const byte *getUpscaledFrame(ResourceHandle &resourceHandle, uint index);
 	void unloadResource(ResourceHandle &resourceHandle);
 
 	void purgeResources();
 protected:
+	Common::ArchiveMemberPtr findUpscaledImage(const Common::String &baseName);
+	bool readUpscaledImageSize(Common::SeekableReadStream &stream, int32 &width, int32 &height);
+	bool decodeUpscaledImage(Common::SeekableReadStream &stream, ResourceHandle::UpscaledData *upscaledData);
+	void decodeUpscaledFrame(ResourceHandle::UpscaledData *upscaledData);
 	void unloadUpscaledResource(ResourceHandle &resourceHandle);
 
-	typedef Common::HashMap<uint32, ResourceFileEntry> EntriesMap;
+	// Animation frames are decoded by a timer callback, off the main thread on
+	// most backends, one per call in the order they were loaded, so that the
+	// other timer callbacks are not held up. _upscaledMutex guards the queue
+	// and the frames in it.
+	static void upscaledFrameTimerProc(void *refCon);
+	void decodeQueuedFrames();
+	Common::Mutex _upscaledMutex;
+	Common::List<ResourceHandle::UpscaledData*> _upscaledQueue;
+
+	// Entries are only added by addArchive() while the game starts, so the
+	// pointers handed out by findEntry() stay valid although the flat map
+	// moves its nodes when it grows. _data is added to by loadResource() and
+	// unloadResource() during the game, which is fine as it holds pointers
+	// and no references into the map are kept.
+	typedef Common::FlatHashMap<uint32, ResourceFileEntry> EntriesMap;
+	typedef Common::FlatHashMap<uint32, ResourceData*> DataMap;
 	Common::Array<BlbArchive*> _archives;
 	EntriesMap _entries;
-	Common::HashMap<uint32, ResourceData*> _data;
+	DataMap _data;
 	Common::Array<Resource*> _resources;
 };
 
@@ -26,6 +26,7 @@
 #include "neverhood/neverhood.h"
 #include "neverhood/gamemodule.h"
 #include "neverhood/gamevars.h"
+#include "neverhood/screen.h"
 
 namespace Neverhood {
 
@@ -75,7 +76,10 @@ bool NeverhoodEngine::savegame(const char *filename, const char *description) {
 	out->writeByte(descriptionLen);
 	out->write(description, descriptionLen);
 
-	Graphics::saveThumbnail(*out);
+	Graphics::Surface thumb;
+	_screen->createThumbnail(thumb);
+	Graphics::saveThumbnail(*out, thumb);
+	thumb.free();
 
 	// Not used yet, reserved for future usage
 	out->writeByte(0);
@@ -0,0 +1,125 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NEVERHOOD_SCALE_H
+#define NEVERHOOD_SCALE_H
+
+#include "common/scummsys.h"
+
+namespace Neverhood {
+
+/**
+ * Scale by a ratio known at compile time. The compiler turns the constant
+ * multiply and divide into shifts and multiplies. Both directions truncate
+ * towards zero, like the plain integer expression does.
+ */
+template<int Dividend, int Divisor>
+struct FixedScale {
+	static inline int32 up(int32 value) { return value * Dividend / Divisor; }
+	static inline int32 down(int32 value) { return value * Divisor / Dividend; }
+};
+
+/**
+ * Converts coordinates between the original 640x480 space and the upscaled
+ * screen space. The ratio is reduced once when it is set and the common
+ * ratios are dispatched to a FixedScale specialisation, so the per-call cost
+ * is a predictable branch plus a constant multiply instead of two divisions.
+ * Every preset gives exactly the same result as the generic path.
+ */
+class ScaleTransform {
+public:
+	enum Preset {
+		kPreset1x,
+		kPreset2x,
+		kPreset3x,
+		kPreset4x,
+		kPreset9x2,
+		kPresetGeneric
+	};
+
+	constexpr ScaleTransform() : _dividend(9), _divisor(2), _preset(kPreset9x2) {}
+	ScaleTransform(int16 dividend, int16 divisor) { set(dividend, divisor); }
+
+	void set(int16 dividend, int16 divisor) {
+		if (dividend <= 0 || divisor <= 0)
+			dividend = divisor = 1;
+		int16 a = dividend, b = divisor;
+		while (b) {
+			int16 t = a % b;
+			a = b;
+			b = t;
+		}
+		_dividend = dividend / a;
+		_divisor = divisor / a;
+		if (_divisor == 1 && _dividend <= 4)
+			_preset = (Preset)(kPreset1x + _dividend - 1);
+		else if (_dividend == 9 && _divisor == 2)
+			_preset = kPreset9x2;
+		else
+			_preset = kPresetGeneric;
+	}
+
+	int16 getDividend() const { return _dividend; }
+	int16 getDivisor() const { return _divisor; }
+	Preset getPreset() const { return _preset; }
+
+	inline int32 up(int32 value) const {
+		switch (_preset) {
+		case kPreset1x:
+			return value;
+		case kPreset2x:
+			return FixedScale<2, 1>::up(value);
+		case kPreset3x:
+			return FixedScale<3, 1>::up(value);
+		case kPreset4x:
+			return FixedScale<4, 1>::up(value);
+		case kPreset9x2:
+			return FixedScale<9, 2>::up(value);
+		default:
+			return value * _dividend / _divisor;
+		}
+	}
+
+	inline int32 down(int32 value) const {
+		switch (_preset) {
+		case kPreset1x:
+			return value;
+		case kPreset2x:
+			return FixedScale<2, 1>::down(value);
+		case kPreset3x:
+			return FixedScale<3, 1>::down(value);
+		case kPreset4x:
+			return FixedScale<4, 1>::down(value);
+		case kPreset9x2:
+			return FixedScale<9, 2>::down(value);
+		default:
+			return value * _divisor / _dividend;
+		}
+	}
+
+private:
+	int16 _dividend, _divisor;
+	Preset _preset;
+};
+
+} // End of namespace Neverhood
+
+#endif /* NEVERHOOD_SCALE_H */
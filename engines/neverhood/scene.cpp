@@ -27,6 +27,9 @@
 
 namespace Neverhood {
 
+// Covers the entity count of all but the busiest scenes
+static const uint kSceneEntityReserve = 64;
+
 Scene::Scene(NeverhoodEngine *vm, Module *parentModule)
 	: Entity(vm, 0), _parentModule(parentModule), _dataResource(vm), _hitRects(nullptr),
 	_mouseCursorWasVisible(true), _palette(nullptr) {
@@ -59,6 +62,9 @@ Scene::Scene(NeverhoodEngine *vm, Module *parentModule)
 	_backgroundFileHash = _cursorFileHash = 0;
 	_rgbOffset = new Graphics::RgbOffset();
 
+	_entities.reserve(kSceneEntityReserve);
+	_surfaces.reserve(kSceneEntityReserve);
+
 	SetUpdateHandler(&Scene::update);
 	SetMessageHandler(&Scene::handleMessage);
 
@@ -242,7 +248,7 @@ void Scene::setHitRects(HitRectList *hitRects) {
 }
 
 Sprite *Scene::insertStaticSprite(uint32 fileHash, int surfacePriority) {
-	return addSprite(new StaticSprite(_vm, fileHash, surfacePriority));
+	return addSprite(new (&_arena) StaticSprite(_vm, fileHash, surfacePriority));
 }
 
 void Scene::insertScreenMouse(uint32 fileHash, const NRect *mouseRect) {
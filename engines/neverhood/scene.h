@@ -69,6 +69,7 @@ public:
 	void showMouse(bool visible);
 	void changeMouseCursor(uint32 fileHash);
 	SmackerPlayer *addSmackerPlayer(SmackerPlayer *smackerPlayer);
+	SmackerPlayer *getSmackerPlayer() const { return _smackerPlayer; }
 	void update();
 	void leaveScene(uint32 result);
 	HitRect *findHitRectAtPos(int16 x, int16 y);
@@ -79,60 +80,60 @@ public:
 	// insertKlaymen
 	template<class T>
 	void insertKlaymen() {
-		_klaymen = (T*)addSprite(new T(_vm, this));
+		_klaymen = (T*)addSprite(new (&_arena) T(_vm, this));
 	}
 	template<class T, class Arg1>
 	void insertKlaymen(Arg1 arg1) {
-		_klaymen = (T*)addSprite(new T(_vm, this, arg1));
+		_klaymen = (T*)addSprite(new (&_arena) T(_vm, this, arg1));
 	}
 	template<class T, class Arg1, class Arg2>
 	void insertKlaymen(Arg1 arg1, Arg2 arg2) {
-		_klaymen = (T*)addSprite(new T(_vm, this, arg1, arg2));
+		_klaymen = (T*)addSprite(new (&_arena) T(_vm, this, arg1, arg2));
 	}
 	template<class T, class Arg1, class Arg2, class Arg3>
 	void insertKlaymen(Arg1 arg1, Arg2 arg2, Arg3 arg3) {
-		_klaymen = (T*)addSprite(new T(_vm, this, arg1, arg2, arg3));
+		_klaymen = (T*)addSprite(new (&_arena) T(_vm, this, arg1, arg2, arg3));
 	}
 	template<class T, class Arg1, class Arg2, class Arg3, class Arg4>
 	void insertKlaymen(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4) {
-		_klaymen = (T*)addSprite(new T(_vm, this, arg1, arg2, arg3, arg4));
+		_klaymen = (T*)addSprite(new (&_arena) T(_vm, this, arg1, arg2, arg3, arg4));
 	}
 	template<class T, class Arg1, class Arg2, class Arg3, class Arg4, class Arg5>
 	void insertKlaymen(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5) {
-		_klaymen = (T*)addSprite(new T(_vm, this, arg1, arg2, arg3, arg4, arg5));
+		_klaymen = (T*)addSprite(new (&_arena) T(_vm, this, arg1, arg2, arg3, arg4, arg5));
 	}
 	template<class T, class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6>
 	void insertKlaymen(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6) {
-		_klaymen = (T*)addSprite(new T(_vm, this, arg1, arg2, arg3, arg4, arg5, arg6));
+		_klaymen = (T*)addSprite(new (&_arena) T(_vm, this, arg1, arg2, arg3, arg4, arg5, arg6));
 	}
 	// insertSprite
 	template<class T>
 	T* insertSprite() {
-		return (T*)addSprite(new T(_vm));
+		return (T*)addSprite(new (&_arena) T(_vm));
 	}
 	template<class T, class Arg1>
 	T* insertSprite(Arg1 arg1) {
-		return (T*)addSprite(new T(_vm, arg1));
+		return (T*)addSprite(new (&_arena) T(_vm, arg1));
 	}
 	template<class T, class Arg1, class Arg2>
 	T* insertSprite(Arg1 arg1, Arg2 arg2) {
-		return (T*)addSprite(new T(_vm, arg1, arg2));
+		return (T*)addSprite(new (&_arena) T(_vm, arg1, arg2));
 	}
 	template<class T, class Arg1, class Arg2, class Arg3>
 	T* insertSprite(Arg1 arg1, Arg2 arg2, Arg3 arg3) {
-		return (T*)addSprite(new T(_vm, arg1, arg2, arg3));
+		return (T*)addSprite(new (&_arena) T(_vm, arg1, arg2, arg3));
 	}
 	template<class T, class Arg1, class Arg2, class Arg3, class Arg4>
 	T* insertSprite(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4) {
-		return (T*)addSprite(new T(_vm, arg1, arg2, arg3, arg4));
+		return (T*)addSprite(new (&_arena) T(_vm, arg1, arg2, arg3, arg4));
 	}
 	template<class T, class Arg1, class Arg2, class Arg3, class Arg4, class Arg5>
 	T* insertSprite(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5) {
-		return (T*)addSprite(new T(_vm, arg1, arg2, arg3, arg4, arg5));
+		return (T*)addSprite(new (&_arena) T(_vm, arg1, arg2, arg3, arg4, arg5));
 	}
 	template<class T, class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6>
 	T* insertSprite(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6) {
-		return (T*)addSprite(new T(_vm, arg1, arg2, arg3, arg4, arg5, arg6));
+		return (T*)addSprite(new (&_arena) T(_vm, arg1, arg2, arg3, arg4, arg5, arg6));
 	}
 	// createSprite
 	template<class T>
@@ -171,6 +172,10 @@ public:
 
 protected:
 	Module *_parentModule;
+	// Sprites inserted by the scene live in its arena, the arena is declared
+	// first so it is destroyed after everything allocated from it. Sprites
+	// from createSprite() are not in the sprite list and go to the heap.
+	SceneArena _arena;
 	Common::Array<Entity*> _entities;
 	Common::Array<BaseSurface*> _surfaces;
 
@@ -0,0 +1,102 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/textconsole.h"
+#include "neverhood/scenearena.h"
+
+namespace Neverhood {
+
+// Most scenes fit into one or two chunks
+static const size_t kArenaChunkSize = 64 * 1024;
+static const size_t kArenaAlignment = 16;
+
+SceneArena *SceneArena::_firstArena = nullptr;
+
+SceneArena::SceneArena()
+	: _nextArena(_firstArena), _current(nullptr), _bytesLeft(0), _allocationCount(0), _liveCount(0), _bytesAllocated(0) {
+	_firstArena = this;
+}
+
+SceneArena::~SceneArena() {
+	// Anything still alive would point into freed memory
+	assert(_liveCount == 0);
+
+	SceneArena **arena = &_firstArena;
+	while (*arena != this)
+		arena = &(*arena)->_nextArena;
+	*arena = _nextArena;
+
+	for (Common::Array<Chunk>::iterator it = _chunks.begin(); it != _chunks.end(); ++it)
+		free(it->data);
+}
+
+SceneArena *SceneArena::findOwner(const void *ptr) {
+	for (SceneArena *arena = _firstArena; arena; arena = arena->_nextArena)
+		if (arena->contains(ptr))
+			return arena;
+	return nullptr;
+}
+
+bool SceneArena::contains(const void *ptr) const {
+	for (Common::Array<Chunk>::const_iterator it = _chunks.begin(); it != _chunks.end(); ++it)
+		if ((const byte *)ptr >= it->data && (const byte *)ptr < it->data + it->size)
+			return true;
+	return false;
+}
+
+void SceneArena::release(void *ptr) {
+	assert(contains(ptr) && _liveCount > 0);
+	_liveCount--;
+}
+
+void *SceneArena::allocate(size_t size) {
+	size = (size + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+
+	if (size > _bytesLeft) {
+		// Oversized objects get a chunk of their own, the current chunk is kept
+		// for the smaller objects that follow
+		const bool ownChunk = size > kArenaChunkSize / 4;
+		const size_t chunkSize = ownChunk ? size : kArenaChunkSize;
+		byte *chunk = (byte *)malloc(chunkSize);
+		if (!chunk)
+			error("SceneArena::allocate() Could not allocate %d bytes", (int)chunkSize);
+		Chunk newChunk = { chunk, chunkSize };
+		_chunks.push_back(newChunk);
+		if (ownChunk) {
+			_allocationCount++;
+			_liveCount++;
+			_bytesAllocated += size;
+			return chunk;
+		}
+		_current = chunk;
+		_bytesLeft = chunkSize;
+	}
+
+	void *ptr = _current;
+	_current += size;
+	_bytesLeft -= size;
+	_allocationCount++;
+	_liveCount++;
+	_bytesAllocated += size;
+	return ptr;
+}
+
+} // End of namespace Neverhood
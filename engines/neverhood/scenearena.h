@@ -0,0 +1,72 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NEVERHOOD_SCENEARENA_H
+#define NEVERHOOD_SCENEARENA_H
+
+#include "common/array.h"
+
+namespace Neverhood {
+
+/**
+ * Bump allocator for objects that live exactly as long as a scene. Memory
+ * is taken from large chunks and never given back individually, all chunks
+ * are freed at once when the arena is destroyed. The objects' destructors
+ * still have to be called by their owners, before the arena is destroyed.
+ */
+class SceneArena {
+public:
+	SceneArena();
+	~SceneArena();
+
+	void *allocate(size_t size);
+	// Called when an object from this arena is deleted, the memory is kept
+	void release(void *ptr);
+	bool contains(const void *ptr) const;
+
+	// Return the live arena ptr was allocated from, or nullptr
+	static SceneArena *findOwner(const void *ptr);
+
+	uint32 getAllocationCount() const { return _allocationCount; }
+	uint32 getBytesAllocated() const { return _bytesAllocated; }
+	uint32 getChunkCount() const { return _chunks.size(); }
+
+protected:
+	struct Chunk {
+		byte *data;
+		size_t size;
+	};
+
+	// All live arenas, there are only a few scenes at a time
+	static SceneArena *_firstArena;
+	SceneArena *_nextArena;
+
+	Common::Array<Chunk> _chunks;
+	byte *_current;
+	size_t _bytesLeft;
+	uint32 _allocationCount;
+	uint32 _liveCount;
+	uint32 _bytesAllocated;
+};
+
+} // End of namespace Neverhood
+
+#endif /* NEVERHOOD_SCENEARENA_H */
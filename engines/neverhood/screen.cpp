@@ -20,12 +20,17 @@
  */
 
 #include "graphics/palette.h"
+#include "graphics/scaler.h"
 #include "video/smk_decoder.h"
 #include "neverhood/screen.h"
+#include "neverhood/thumbnail.h"
 #include "image/png.h"
 
 namespace Neverhood {
 
+// Enough to keep the sprites of a couple of scenes around at 4K
+static const uint32 kMaxPooledSurfaceBytes = 256 * 1024 * 1024;
+
 Screen::Screen(NeverhoodEngine *vm)
 	: _vm(vm), _paletteData(nullptr), _paletteChanged(false), _smackerDecoder(nullptr),
 	_yOffset(0), _fullRefresh(false), _frameDelay(0), _savedSmackerDecoder(nullptr),
@@ -33,12 +38,16 @@ Screen::Screen(NeverhoodEngine *vm)
 
 	_ticks = _vm->_system->getMillis();
 
+	if (calcPitch(UPSCALE_X(640), 4) > kMaxSurfacePitch)
+		error("Screen::Screen() Upscale ratio %d/%d gives a back buffer too wide for a surface", NeverhoodEngine::_scale.getDividend(), NeverhoodEngine::_scale.getDivisor());
+
 	_backScreen = new Graphics::Surface();
 	_backScreen->create(UPSCALE(640, 480), Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24)); //Graphics::PixelFormat::createFormatCLUT8());
 
 	_renderQueue = new RenderQueue();
 	_prevRenderQueue = new RenderQueue();
 	_microTiles = new MicroTileArray(UPSCALE(640, 480));
+	_surfacePool = new SurfacePool(kMaxPooledSurfaceBytes);
 
 }
 
@@ -48,6 +57,7 @@ Screen::~Screen() {
 	delete _prevRenderQueue;
 	_backScreen->free();
 	delete _backScreen;
+	delete _surfacePool;
 }
 
 void Screen::update() {
@@ -79,13 +89,13 @@ void Screen::update() {
 	for (RenderQueue::iterator jt = _prevRenderQueue->begin(); jt != _prevRenderQueue->end(); ++jt) {
 		RenderItem &prevRenderItem = (*jt);
 		if (prevRenderItem._refresh)
-			_microTiles->addRect(Common::Rect(prevRenderItem._destX, prevRenderItem._destY, prevRenderItem._destX + prevRenderItem._width, prevRenderItem._destY + prevRenderItem._height));
+			_microTiles->addRect(NRect::make(prevRenderItem._destX, prevRenderItem._destY, prevRenderItem._destX + prevRenderItem._width, prevRenderItem._destY + prevRenderItem._height));
 	}
 
 	for (RenderQueue::iterator it = _renderQueue->begin(); it != _renderQueue->end(); ++it) {
 		RenderItem &renderItem = (*it);
 		if (renderItem._refresh)
-			_microTiles->addRect(Common::Rect(renderItem._destX, renderItem._destY, renderItem._destX + renderItem._width, renderItem._destY + renderItem._height));
+			_microTiles->addRect(NRect::make(renderItem._destX, renderItem._destY, renderItem._destX + renderItem._width, renderItem._destY + renderItem._height));
 		renderItem._refresh = true;
 	}
 
@@ -97,12 +107,14 @@ void Screen::update() {
 			blitRenderItem(renderItem, *ri);
 	}
 
+	// Keep the storage of the queue, it is refilled to about the same size
+	// every frame and only released by clearRenderQueue() on scene changes
 	SWAP(_renderQueue, _prevRenderQueue);
-	_renderQueue->clear();
+	_renderQueue->resize(0);
 
 	for (RectangleList::iterator ri = updateRects->begin(); ri != updateRects->end(); ++ri) {
-		Common::Rect &r = *ri;
-		_vm->_system->copyRectToScreen((const byte*)_backScreen->getBasePtr(r.left, r.top), _backScreen->pitch, r.left, r.top, r.width(), r.height());
+		NRect &r = *ri;
+		_vm->_system->copyRectToScreen(getPixelPtr(_backScreen, r.x1, r.y1), _backScreen->pitch, r.x1, r.y1, r.width(), r.height());
 	}
 
 	delete updateRects;
@@ -137,11 +149,11 @@ int Screen::getFps() {
 	return 1000 / _frameDelay;
 }
 
-void Screen::setYOffset(int16 yOffset) {
+void Screen::setYOffset(NCoord yOffset) {
 	_yOffset = yOffset;
 }
 
-int16 Screen::getYOffset() {
+NCoord Screen::getYOffset() {
 	return _yOffset;
 }
 
@@ -182,6 +194,41 @@ void Screen::clear() {
 	clearRenderQueue();
 }
 
+void Screen::createThumbnail(Graphics::Surface &thumb) {
+	// Box filter the back buffer straight down to the thumbnail size instead
+	// of grabbing and converting the whole upscaled screen first. Every
+	// thumbnail pixel is the average of the screen pixels it covers, see
+	// sumThumbnailRow().
+	const int thumbWidth = kThumbnailWidth;
+	const int thumbHeight = kThumbnailHeight2;
+	const int srcWidth = _backScreen->w;
+	const int srcHeight = _backScreen->h;
+
+	thumb.create(thumbWidth, thumbHeight, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+
+	Common::Array<int> columns(thumbWidth + 1);
+	for (int tx = 0; tx <= thumbWidth; tx++)
+		columns[tx] = tx * srcWidth / thumbWidth;
+
+	Common::Array<uint32> sums(thumbWidth * 3);
+
+	for (int ty = 0; ty < thumbHeight; ty++) {
+		const int srcY0 = ty * srcHeight / thumbHeight;
+		const int srcY1 = MAX((ty + 1) * srcHeight / thumbHeight, srcY0 + 1);
+
+		Common::fill(sums.begin(), sums.end(), 0);
+		for (int sy = srcY0; sy < srcY1; sy++)
+			sumThumbnailRow(getPixelPtr(_backScreen, 0, sy), columns.begin(), thumbWidth, _backScreen->format, sums.begin());
+
+		uint16 *dest = (uint16*)thumb.getBasePtr(0, ty);
+		const uint32 *sum = sums.begin();
+		for (int tx = 0; tx < thumbWidth; tx++, sum += 3) {
+			const uint32 count = MAX(columns[tx + 1] - columns[tx], 1) * (srcY1 - srcY0);
+			*dest++ = thumb.format.RGBToColor(sum[0] / count, sum[1] / count, sum[2] / count);
+		}
+	}
+}
+
 void Screen::clearRenderQueue() {
 	_renderQueue->clear();
 	_prevRenderQueue->clear();
@@ -190,7 +237,7 @@ void Screen::clearRenderQueue() {
 void Screen::drawSurface2(const Graphics::Surface *surface, NDrawRect &drawRect, NRect &clipRect, bool transparent, byte version,
 	const Graphics::Surface *shadowSurface) {
 
-	int16 destX, destY;
+	NCoord destX, destY;
 	NRect ddRect;
 
 	if (drawRect.x + drawRect.width >= clipRect.x2)
@@ -223,9 +270,9 @@ void Screen::drawSurface2(const Graphics::Surface *surface, NDrawRect &drawRect,
 
 }
 
-void Screen::drawSurface3(const Graphics::Surface *surface, int16 x, int16 y, NDrawRect &drawRect, NRect &clipRect, bool transparent, byte version) {
+void Screen::drawSurface3(const Graphics::Surface *surface, NCoord x, NCoord y, NDrawRect &drawRect, NRect &clipRect, bool transparent, byte version) {
 
-	int16 destX, destY;
+	NCoord destX, destY;
 	NRect ddRect;
 
 	if (x + drawRect.width >= clipRect.x2)
@@ -260,13 +307,13 @@ void Screen::drawSurface3(const Graphics::Surface *surface, int16 x, int16 y, ND
 
 void Screen::drawDoubleSurface2(const Graphics::Surface *surface, NDrawRect &drawRect) {
 
-	drawRect.x = MAX((int16)0, drawRect.x);
-	drawRect.y = MAX((int16)0, drawRect.y);
+	drawRect.x = MAX<NCoord>(0, drawRect.x);
+	drawRect.y = MAX<NCoord>(0, drawRect.y);
 
 	const byte *source = (const byte*)surface->getPixels();
-	byte *dest = (byte*)_backScreen->getBasePtr(drawRect.x, drawRect.y);
+	byte *dest = getPixelPtr(_backScreen, drawRect.x, drawRect.y);
 
-	for (int16 yc = 0; yc < surface->h; yc++) {
+	for (int yc = 0; yc < surface->h; yc++) {
 		memcpy(dest, source, surface->w * 4);
 		source += surface->pitch;
 		dest += _backScreen->pitch;
@@ -278,7 +325,7 @@ void Screen::drawDoubleSurface2(const Graphics::Surface *surface, NDrawRect &dra
 
 void Screen::drawUnk(const Graphics::Surface *surface, NDrawRect &drawRect, NDrawRect &sysRect, NRect &clipRect, bool transparent, byte version) {
 
-	int16 x, y;
+	NCoord x, y;
 	bool xflag, yflag;
 	NDrawRect newDrawRect;
 
@@ -349,7 +396,7 @@ void Screen::drawSurfaceClipRects(const Graphics::Surface *surface, NDrawRect &d
 		drawSurface3(surface, drawRect.x, drawRect.y, clipDrawRect, clipRects[i], transparent, version);
 }
 
-void Screen::queueBlit(const Graphics::Surface *surface, int16 destX, int16 destY, NRect &ddRect, bool transparent, byte version,
+void Screen::queueBlit(const Graphics::Surface *surface, NCoord destX, NCoord destY, NRect &ddRect, bool transparent, byte version,
 	const Graphics::Surface *shadowSurface) {
 
 	const int width = ddRect.x2 - ddRect.x1;
@@ -373,31 +420,28 @@ void Screen::queueBlit(const Graphics::Surface *surface, int16 destX, int16 dest
 
 }
 
-void Screen::blitRenderItem(const RenderItem &renderItem, const Common::Rect &clipRect) {
+void Screen::blitRenderItem(const RenderItem &renderItem, const NRect &clipRect) {
 
 	const Graphics::Surface *surface = renderItem._surface;
 	const Graphics::Surface *shadowSurface = renderItem._shadowSurface;
-	const int16 x0 = MAX<int16>(clipRect.left, renderItem._destX);
-	const int16 y0 = MAX<int16>(clipRect.top, renderItem._destY);
-	const int16 x1 = MIN<int16>(clipRect.right, renderItem._destX + renderItem._width);
-	const int16 y1 = MIN<int16>(clipRect.bottom, renderItem._destY + renderItem._height);
-	const int16 width = x1 - x0;
-	int16 height = y1 - y0;
-	int16 bytes_per_pixel = 4;
+	const NCoord x0 = MAX<NCoord>(clipRect.x1, renderItem._destX);
+	const NCoord y0 = MAX<NCoord>(clipRect.y1, renderItem._destY);
+	const NCoord x1 = MIN<NCoord>(clipRect.x2, renderItem._destX + renderItem._width);
+	const NCoord y1 = MIN<NCoord>(clipRect.y2, renderItem._destY + renderItem._height);
+	const NCoord width = x1 - x0;
+	NCoord height = y1 - y0;
+	const uint bytes_per_pixel = 4;
 
 	if (width < 0 || height < 0)
 		return;
 
-	const byte *source = (const byte*)surface->getBasePtr(renderItem._srcX + x0 - renderItem._destX, renderItem._srcY + y0 - renderItem._destY);
-	byte *dest = (byte*)_backScreen->getBasePtr(x0, y0);
+	const byte *source = getPixelPtr(surface, renderItem._srcX + x0 - renderItem._destX, renderItem._srcY + y0 - renderItem._destY);
+	byte *dest = getPixelPtr(_backScreen, x0, y0);
 
 	if (shadowSurface) {
-		const byte *shadowSource = (const byte*)shadowSurface->getBasePtr(x0, y0);
+		const byte *shadowSource = getPixelPtr(shadowSurface, x0, y0);
 		while (height--) {
-			for (int xc = 0; xc < width * bytes_per_pixel; xc += bytes_per_pixel) {
-				if (*(source + getAlphaOffset(xc, bytes_per_pixel)) > 0)
-					blendColor(dest + xc, shadowSource + xc, bytes_per_pixel, shadowSurface->GetRgbOffset());
-			}
+			blendShadowSpan(dest, source, shadowSource, width, shadowSurface->GetRgbOffset());
 			source += surface->pitch;
 			shadowSource += shadowSurface->pitch;
 			dest += _backScreen->pitch;
@@ -410,7 +454,7 @@ void Screen::blitRenderItem(const RenderItem &renderItem, const Common::Rect &cl
 		}
 	} else {
 		while (height--) {
-			for (int xc = 0; xc < width * bytes_per_pixel; xc += bytes_per_pixel)
+			for (uint xc = 0; xc < width * bytes_per_pixel; xc += bytes_per_pixel)
 				blendColor(dest + xc, source + xc, bytes_per_pixel, surface->GetRgbOffset());
 			source += surface->pitch;
 			dest += _backScreen->pitch;
@@ -27,6 +27,7 @@
 #include "neverhood/neverhood.h"
 #include "neverhood/microtiles.h"
 #include "neverhood/graphics.h"
+#include "neverhood/surfacepool.h"
 #include "video/theora_decoder.h"
 
 namespace Video {
@@ -38,8 +39,8 @@ namespace Neverhood {
 struct RenderItem {
 	const Graphics::Surface *_surface;
 	const Graphics::Surface *_shadowSurface;
-	int16 _destX, _destY;
-	int16 _srcX, _srcY, _width, _height;
+	NCoord _destX, _destY;
+	NCoord _srcX, _srcY, _width, _height;
 	bool _transparent;
 	byte _version;
 	bool _refresh;
@@ -70,8 +71,8 @@ public:
 	void restoreParams();
 	void setFps(int fps);
 	int getFps();
-	void setYOffset(int16 yOffset);
-	int16 getYOffset();
+	void setYOffset(NCoord yOffset);
+	NCoord getYOffset();
 	void setPaletteData(byte *paletteData);
 	void unsetPaletteData(byte *paletteData);
 	byte *getPaletteData() { return _paletteData; }
@@ -81,14 +82,16 @@ public:
 	void clearRenderQueue();
 	void drawSurface2(const Graphics::Surface *surface, NDrawRect &drawRect, NRect &clipRect, bool transparent, byte version,
 		const Graphics::Surface *shadowSurface = NULL);
-	void drawSurface3(const Graphics::Surface *surface, int16 x, int16 y, NDrawRect &drawRect, NRect &clipRect, bool transparent, byte version);
+	void drawSurface3(const Graphics::Surface *surface, NCoord x, NCoord y, NDrawRect &drawRect, NRect &clipRect, bool transparent, byte version);
 	void drawDoubleSurface2(const Graphics::Surface *surface, NDrawRect &drawRect);
 	void drawUnk(const Graphics::Surface *surface, NDrawRect &drawRect, NDrawRect &sysRect, NRect &clipRect, bool transparent, byte version);
 	void drawSurfaceClipRects(const Graphics::Surface *surface, NDrawRect &drawRect, NRect *clipRects, uint clipRectsCount, bool transparent, byte version);
 	void setSmackerDecoder(Video::TheoraDecoder *smackerDecoder) { _smackerDecoder = smackerDecoder; }
-	void queueBlit(const Graphics::Surface *surface, int16 destX, int16 destY, NRect &ddRect, bool transparent, byte version,
+	void queueBlit(const Graphics::Surface *surface, NCoord destX, NCoord destY, NRect &ddRect, bool transparent, byte version,
 		const Graphics::Surface *shadowSurface = NULL);
-	void blitRenderItem(const RenderItem &renderItem, const Common::Rect &clipRect);
+	void blitRenderItem(const RenderItem &renderItem, const NRect &clipRect);
+	SurfacePool *getSurfacePool() { return _surfacePool; }
+	void createThumbnail(Graphics::Surface &thumb);
 protected:
 	NeverhoodEngine *_vm;
 	MicroTileArray *_microTiles;
@@ -98,9 +101,10 @@ protected:
 	int32 _frameDelay, _savedFrameDelay;
 	byte *_paletteData;
 	bool _paletteChanged;
-	int16 _yOffset, _savedYOffset;
+	NCoord _yOffset, _savedYOffset;
 	bool _fullRefresh;
 	RenderQueue *_renderQueue, *_prevRenderQueue;
+	SurfacePool *_surfacePool;
 };
 
 } // End of namespace Neverhood
@@ -0,0 +1,36 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NEVERHOOD_SIMD_H
+#define NEVERHOOD_SIMD_H
+
+#include "common/scummsys.h"
+
+// The SSE2 kernels have to give exactly the same results as their scalar
+// paths. They read channels by their byte position, which follows from the
+// pixel format shifts only on little endian, and the scalar float math of
+// blendColor() is plain SSE only on x86-64.
+#if defined(SCUMM_LITTLE_ENDIAN) && ((defined(__SSE2__) && defined(__x86_64__)) || defined(_M_X64))
+#define NEVERHOOD_SSE2
+#include <emmintrin.h>
+#endif
+
+#endif /* NEVERHOOD_SIMD_H */
@@ -29,6 +29,10 @@
 
 namespace Neverhood {
 
+// The OGV file is read ahead in chunks of this size, see SmackerPlayer::createDecoder()
+static const uint32 kVideoChunkSize = 64 * 1024;
+static const uint kVideoChunkCount = 4;
+
 // SmackerSurface
 
 SmackerSurface::SmackerSurface(NeverhoodEngine *vm)
@@ -92,7 +96,9 @@ void NeverhoodSmackerDecoder::forceSeekToFrame(uint frame) {
 SmackerPlayer::SmackerPlayer(NeverhoodEngine *vm, Scene *scene, uint32 fileHash, bool doubleSurface, bool flag, bool paused)
 	: Entity(vm, 0), _scene(scene), _doubleSurface(doubleSurface), _videoDone(false), _paused(paused),
 	_palette(nullptr), _smackerDecoder(nullptr), _smackerSurface(nullptr), _stream(nullptr), _smackerFirst(true),
-	_drawX(-1), _drawY(-1) {
+	_drawX(-1), _drawY(-1), _nextSmackerDecoder(nullptr), _nextSmackerFrame(nullptr), _nextFileHash(0) {
+
+	memset(&_stats, 0, sizeof(_stats));
 
 	SetUpdateHandler(&SmackerPlayer::update);
 
@@ -107,6 +113,7 @@ SmackerPlayer::SmackerPlayer(NeverhoodEngine *vm, Scene *scene, uint32 fileHash,
 
 SmackerPlayer::~SmackerPlayer() {
 	close();
+	closeNext();
 	delete _smackerSurface;
 	_smackerSurface = nullptr;
 }
@@ -114,24 +121,26 @@ SmackerPlayer::~SmackerPlayer() {
 void SmackerPlayer::open(uint32 fileHash, bool keepLastFrame) {
 	debug(0, "SmackerPlayer::open(%08X)", fileHash);
 
+	close();
+
 	_fileHash = fileHash;
 	_keepLastFrame = keepLastFrame;
 
-	close();
-
 	_smackerFirst = true;
-
-	Common::String folder = ConfigData::get()->looseDataFolder + "/videos";
-	Common::String fname = Common::String::format("%08X", fileHash);
-	Common::String name = Common::String::format("%s/%s.ogv", folder.c_str(), fname.c_str());
-
-	Common::File *file = new Common::File();
-	file->open(name);
+	_videoDone = false;
+	memset(&_stats, 0, sizeof(_stats));
 
 	_stream = _vm->_res->createStream(fileHash);
 
-	_smackerDecoder = new NeverhoodSmackerDecoder();
-	_smackerDecoder->loadStream(file);//_stream);
+	if (isNextPrerolled(fileHash)) {
+		// Header and first frame are already decoded, switch over right away
+		_smackerDecoder = _nextSmackerDecoder;
+		_nextSmackerDecoder = nullptr;
+		_nextFileHash = 0;
+	} else {
+		closeNext();
+		_smackerDecoder = createDecoder(fileHash);
+	}
 
 	_palette = new Palette(_vm);
 	_palette->usePalette();
@@ -139,11 +148,61 @@ void SmackerPlayer::open(uint32 fileHash, bool keepLastFrame) {
 	if (!_paused)
 		_smackerDecoder->start();
 
+	if (_nextSmackerFrame) {
+		// The prerolled frame stays up until the next frame is due, see update()
+		setFrame(_nextSmackerFrame);
+		_nextSmackerFrame = nullptr;
+	}
+
+}
+
+NeverhoodSmackerDecoder *SmackerPlayer::createDecoder(uint32 fileHash) {
+	Common::String folder = ConfigData::get()->looseDataFolder + "/videos";
+	Common::String fname = Common::String::format("%08X", fileHash);
+	Common::String name = Common::String::format("%s/%s.ogv", folder.c_str(), fname.c_str());
+
+	Common::File *file = new Common::File();
+	Common::SeekableReadStream *stream = file;
+	if (file->open(name)) {
+		// The file is read ahead from a timer callback, so the decoder
+		// rarely has to wait for the disk in the middle of a frame
+		Common::PrefetchingReadStream *videoStream = Common::wrapPrefetchingReadStream(file, kVideoChunkSize, kVideoChunkCount, DisposeAfterUse::YES);
+		videoStream->startBackgroundPrefetch();
+		stream = videoStream;
+	}
+
+	// The stream belongs to the decoder
+	NeverhoodSmackerDecoder *smackerDecoder = new NeverhoodSmackerDecoder();
+	smackerDecoder->loadStream(stream);
+	return smackerDecoder;
+}
+
+void SmackerPlayer::setNextFileHash(uint32 fileHash) {
+	if (_nextFileHash != fileHash) {
+		closeNext();
+		_nextFileHash = fileHash;
+	}
+}
+
+void SmackerPlayer::prerollNext() {
+	_nextSmackerDecoder = createDecoder(_nextFileHash);
+	if (_nextSmackerDecoder->isVideoLoaded())
+		_nextSmackerFrame = _nextSmackerDecoder->decodeNextFrame();
+}
+
+void SmackerPlayer::closeNext() {
+	delete _nextSmackerDecoder;
+	_nextSmackerDecoder = nullptr;
+	_nextSmackerFrame = nullptr;
+	_nextFileHash = 0;
 }
 
 void SmackerPlayer::close() {
-	if (_smackerDecoder)
+	if (_smackerDecoder) {
+		debug(1, "SmackerPlayer::close(%08X) %u frames presented, %u dropped, %u late, max A/V drift %d ms",
+			_fileHash, _stats.presentedFrames, _stats.droppedFrames, _stats.lateFrames, _stats.maxDrift);
 		_smackerDecoder->stop();
+	}
 	delete _smackerDecoder;
 	delete _palette;
 	// NOTE The SmackerDecoder deletes the _stream
@@ -196,12 +255,17 @@ void SmackerPlayer::update() {
 			updateFrame();
 	} else {
 		if (!_smackerDecoder->endOfVideo()) {
-			updateFrame();
+			if (_smackerFirst || _smackerDecoder->needsUpdate())
+				presentFrame();
+			// Open the next video once the current one is running, so the
+			// loading cost is spread over the playback instead of a gap
+			if (_nextFileHash && !_nextSmackerDecoder && !_smackerFirst)
+				prerollNext();
 		} else if (!_keepLastFrame) {
+			_videoDone = true;
 			// Inform the scene about the end of the video playback
 			if (_scene)
 				sendMessage(_scene, NM_ANIMATION_STOP, 0);
-			_videoDone = true;
 		} else {
 			rewind();
 			updateFrame();
@@ -211,12 +275,41 @@ void SmackerPlayer::update() {
 
 }
 
+void SmackerPlayer::presentFrame() {
+	// The decoder clock follows the audio track. Frames that are already
+	// late are dropped before they are converted to RGB, so a busy CPU
+	// shows fewer frames instead of letting the video lag behind the audio.
+	while (_smackerDecoder->isNextFrameLate()) {
+		_smackerDecoder->skipNextFrame();
+		_stats.droppedFrames++;
+	}
+
+	if (!_smackerFirst) {
+		const int32 drift = ABS<int32>((int32)_smackerDecoder->getTime() - (int32)_smackerDecoder->getNextFrameStartTime());
+		_stats.maxDrift = MAX(_stats.maxDrift, drift);
+		if (drift > 100) {
+			_stats.lateFrames++;
+			debug(2, "SmackerPlayer::presentFrame() frame %d is %d ms off the audio clock", _smackerDecoder->getCurFrame() + 1, drift);
+		}
+	}
+
+	updateFrame();
+	_stats.presentedFrames++;
+}
+
 void SmackerPlayer::updateFrame() {
 
 	if (!_smackerDecoder || !_smackerSurface)
 		return;
 
-	const Graphics::Surface *smackerFrame = _smackerDecoder->decodeNextFrame();
+	setFrame(_smackerDecoder->decodeNextFrame());
+
+	if (_smackerDecoder->hasDirtyPalette())
+		updatePalette();
+
+}
+
+void SmackerPlayer::setFrame(const Graphics::Surface *smackerFrame) {
 
 	if (_smackerFirst) {
 		_smackerSurface->setSmackerFrame(smackerFrame);
@@ -234,9 +327,6 @@ void SmackerPlayer::updateFrame() {
 		_smackerFirst = false;
 	}
 
-	if (_smackerDecoder->hasDirtyPalette())
-		updatePalette();
-
 }
 
 void SmackerPlayer::updatePalette() {
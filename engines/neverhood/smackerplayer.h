@@ -22,6 +22,7 @@
 #ifndef NEVERHOOD_SMACKERPLAYER_H
 #define NEVERHOOD_SMACKERPLAYER_H
 
+#include "common/prefetchstream.h"
 #include "video/smk_decoder.h"
 #include "neverhood/neverhood.h"
 #include "neverhood/entity.h"
@@ -55,11 +56,22 @@ public:
 
 class SmackerPlayer : public Entity {
 public:
+	// Presentation statistics of the current video, see presentFrame()
+	struct PresentationStats {
+		uint presentedFrames;
+		uint droppedFrames;
+		uint lateFrames;	// Presented more than 100 ms off the audio clock
+		int32 maxDrift;		// In ms
+	};
 	SmackerPlayer(NeverhoodEngine *vm, Scene *scene, uint32 fileHash, bool doubleSurface, bool flag, bool paused = false);
 	~SmackerPlayer() override;
 	BaseSurface *getSurface() { return _smackerSurface; }
 	void open(uint32 fileHash, bool keepLastFrame);
 	void close();
+	// Opens the given video in the background so that a following open() of the same
+	// file hash can switch over without loading
+	void setNextFileHash(uint32 fileHash);
+	bool isNextPrerolled(uint32 fileHash) const { return _nextSmackerDecoder && _nextFileHash == fileHash; }
 	void gotoFrame(int frameNumber);
 	uint32 getFrameCount();
 	uint32 getFrameNumber();
@@ -68,6 +80,8 @@ public:
 	void rewind();
 	bool isDone() { return getFrameNumber() + 1 == getFrameCount(); }
 	NeverhoodSmackerDecoder *getSmackerDecoder() const { return _smackerDecoder; }
+	uint32 getFileHash() const { return _fileHash; }
+	const PresentationStats &getPresentationStats() const { return _stats; }
 protected:
 	Scene *_scene;
 	Palette *_palette;
@@ -81,8 +95,17 @@ protected:
 	bool _videoDone;
 	bool _paused;
 	int _drawX, _drawY;
+	NeverhoodSmackerDecoder *_nextSmackerDecoder;
+	const Graphics::Surface *_nextSmackerFrame;
+	uint32 _nextFileHash;
+	PresentationStats _stats;
+	NeverhoodSmackerDecoder *createDecoder(uint32 fileHash);
+	void prerollNext();
+	void closeNext();
 	void update();
+	void presentFrame();
 	void updateFrame();
+	void setFrame(const Graphics::Surface *smackerFrame);
 	void updatePalette();
 };
 
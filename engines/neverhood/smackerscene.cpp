@@ -86,6 +86,7 @@ void SmackerScene::nextVideo() {
 		else
 			_smackerPlayer->open(smackerFileHash, false);
 		_vm->_screen->setSmackerDecoder(_smackerPlayer->getSmackerDecoder());
+		prerollNextVideo();
 	} else {
 		_vm->_screen->setSmackerDecoder(nullptr);
 		sendMessage(_parentModule, 0x1009, 0);
@@ -93,12 +94,30 @@ void SmackerScene::nextVideo() {
 
 }
 
+void SmackerScene::prerollNextVideo() {
+	uint32 nextFileHash = _fileHashList[_fileHashListIndex + 1];
+	if (nextFileHash != 0) {
+		ResourceHandle resourceHandle;
+		_vm->_res->queryResource(nextFileHash, resourceHandle);
+		if (resourceHandle.type() != kResTypeVideo)
+			nextFileHash = 0;
+	}
+	_smackerPlayer->setNextFileHash(nextFileHash);
+}
+
 void SmackerScene::update() {
 	if (_playNextVideoFlag) {
 		nextVideo();
 		_playNextVideoFlag = false;
 	}
 	Scene::update();
+	// The SmackerPlayer reports the end of a video from its update(), switch
+	// to a prerolled video on the same frame once that has returned
+	if (_playNextVideoFlag && _fileHashList && _fileHashList[_fileHashListIndex] != 0 &&
+		_smackerPlayer->isNextPrerolled(_fileHashList[_fileHashListIndex + 1])) {
+		nextVideo();
+		_playNextVideoFlag = false;
+	}
 }
 
 uint32 SmackerScene::handleMessage(int messageNum, const MessageParam &param, Entity *sender) {
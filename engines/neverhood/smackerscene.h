@@ -45,6 +45,7 @@ protected:
 	int _fileHashListIndex;
 	const uint32 *_fileHashList;
 	uint32 _fileHash[2];
+	void prerollNextVideo();
 	void update();
 	uint32 handleMessage(int messageNum, const MessageParam &param, Entity *sender);
 };
@@ -19,8 +19,16 @@
  *
  */
 
+#include "common/file.h"
 #include "common/memstream.h"
+#include "common/prefetchstream.h"
+#include "common/system.h"
+#include "common/timer.h"
 #include "audio/mixer.h"
+#include "audio/decoders/flac.h"
+#include "audio/decoders/raw.h"
+#include "audio/decoders/vorbis.h"
+#include "neverhood/delta.h"
 #include "neverhood/sound.h"
 #include "neverhood/resource.h"
 #include "neverhood/resourceman.h"
@@ -33,6 +41,40 @@
 
 namespace Neverhood {
 
+// Sounds are decoded once and kept until this budget is reached, longer
+// sounds are still decoded while they play
+static const uint32 kMaxDecodedSoundBytes = 16 * 1024 * 1024;
+static const uint32 kMaxDecodedSoundSize = 2 * 1024 * 1024;
+
+// Loose music is decoded this far ahead of the mixer, in buffers of
+// kLooseBufferSamples samples
+static const uint kLooseBufferSamples = 4096;
+static const uint kLooseQueuedBuffers = 8;
+
+// BLB music is read by the mixer, from chunks which a timer callback reads
+// ahead of it. 4 chunks of 16K hold about 3 seconds of music.
+static const uint32 kMusicChunkSize = 16 * 1024;
+static const uint kMusicChunkCount = 4;
+
+// Opens a replacement for a BLB sound from the audio folder of the loose
+// data pack, Ogg Vorbis is preferred over FLAC
+static Audio::SeekableAudioStream *openLooseAudioFile(uint32 fileHash) {
+	const Common::String fname = Common::String::format("%s/audio/%08X", ConfigData::get()->looseDataFolder.c_str(), fileHash);
+	Common::File *file = new Common::File();
+
+#ifdef USE_VORBIS
+	if (file->open(fname + ".ogg"))
+		return Audio::makeVorbisStream(file, DisposeAfterUse::YES);
+#endif
+#ifdef USE_FLAC
+	if (file->open(fname + ".flac"))
+		return Audio::makeFLACStream(file, DisposeAfterUse::YES);
+#endif
+
+	delete file;
+	return nullptr;
+}
+
 SoundResource::SoundResource(NeverhoodEngine *vm)
 	: _vm(vm), _soundIndex(-1) {
 }
@@ -564,10 +606,8 @@ int NeverhoodAudioStream::readBuffer(int16 *buffer, const int numSamples) {
 
 		const byte *src = _buffer;
 		if (_isCompressed) {
-			while (samplesRead--) {
-				_prevValue += (int8)(*src++);
-				*buffer++ = _prevValue << _shiftValue;
-			}
+			decodeDeltaSamples(src, buffer, samplesRead, _prevValue, _shiftValue);
+			buffer += samplesRead;
 		} else {
 			while (samplesRead--) {
 				*buffer++ = READ_LE_UINT16(src);
@@ -589,6 +629,30 @@ int NeverhoodAudioStream::readBuffer(int16 *buffer, const int numSamples) {
 	return numSamples - samplesLeft;
 }
 
+NeverhoodDecodedAudioStream::NeverhoodDecodedAudioStream(int rate, bool isLooping, const DecodedSound *samples)
+	: _rate(rate), _isLooping(isLooping), _samples(samples), _position(0), _endOfData(samples->empty()) {
+}
+
+int NeverhoodDecodedAudioStream::readBuffer(int16 *buffer, const int numSamples) {
+	int samplesLeft = numSamples;
+
+	while (samplesLeft > 0 && !_endOfData) {
+		const uint32 samplesCopied = MIN<uint32>(samplesLeft, _samples->size() - _position);
+		memcpy(buffer, _samples->begin() + _position, samplesCopied * sizeof(int16));
+		buffer += samplesCopied;
+		samplesLeft -= samplesCopied;
+		_position += samplesCopied;
+		if (_position >= _samples->size()) {
+			if (_isLooping)
+				_position = 0;
+			else
+				_endOfData = true;
+		}
+	}
+
+	return numSamples - samplesLeft;
+}
+
 AudioResourceManSoundItem::AudioResourceManSoundItem(NeverhoodEngine *vm, uint32 fileHash)
 	: _vm(vm), _fileHash(fileHash), _data(nullptr), _isLoaded(false), _isPlaying(false),
 	_volume(100), _panning(50) {
@@ -629,12 +693,33 @@ void AudioResourceManSoundItem::setPan(int16 pan) {
 }
 
 void AudioResourceManSoundItem::playSound(bool looping) {
+	// A sound played again starts over, like a DirectSound buffer. The old
+	// stream would otherwise go on reading decoded samples which are no
+	// longer known to be in use.
+	if (_vm->_mixer->isSoundHandleActive(*_soundHandle))
+		_vm->_mixer->stopHandle(*_soundHandle);
+
+	Audio::SeekableAudioStream *looseStream = _vm->_audioResourceMan->openLooseAudio(_fileHash);
+	if (looseStream) {
+		_vm->_mixer->playStream(Audio::Mixer::kSFXSoundType, _soundHandle,
+			Audio::makeLoopingAudioStream(looseStream, looping ? 0 : 1), -1, VOLUME(_volume), PANNING(_panning));
+		debug(1, "playing loose sound %08X", _fileHash);
+		_isPlaying = true;
+		return;
+	}
+
 	if (!_data)
 		loadSound();
 	if (_data) {
 		const byte *shiftValue = _resourceHandle.extData();
-		Common::MemoryReadStream *stream = new Common::MemoryReadStream(_data, _resourceHandle.size(), DisposeAfterUse::NO);
-		NeverhoodAudioStream *audioStream = new NeverhoodAudioStream(22050, *shiftValue, looping, DisposeAfterUse::YES, stream);
+		const DecodedSound *samples = _vm->_audioResourceMan->getDecodedSound(_fileHash, _data, _resourceHandle.size(), *shiftValue);
+		Audio::AudioStream *audioStream;
+		if (samples) {
+			audioStream = new NeverhoodDecodedAudioStream(22050, looping, samples);
+		} else {
+			Common::MemoryReadStream *stream = new Common::MemoryReadStream(_data, _resourceHandle.size(), DisposeAfterUse::NO);
+			audioStream = new NeverhoodAudioStream(22050, *shiftValue, looping, DisposeAfterUse::YES, stream);
+		}
 		_vm->_mixer->playStream(Audio::Mixer::kSFXSoundType, _soundHandle,
 			audioStream, -1, VOLUME(_volume), PANNING(_panning));
 		debug(1, "playing sound %08X", _fileHash);
@@ -655,12 +740,13 @@ bool AudioResourceManSoundItem::isPlaying() {
 AudioResourceManMusicItem::AudioResourceManMusicItem(NeverhoodEngine *vm, uint32 fileHash)
 	: _vm(vm), _fileHash(fileHash), _terminate(false), _canRestart(false),
 	_volume(100), _panning(50),	_start(false), _isFadingIn(false), _isFadingOut(false), _isPlaying(false),
-	_fadeVolume(0), _fadeVolumeStep(0) {
+	_fadeVolume(0), _fadeVolumeStep(0), _looseStream(nullptr), _looseQueue(nullptr) {
 
 	_soundHandle = new Audio::SoundHandle();
 }
 
 AudioResourceManMusicItem::~AudioResourceManMusicItem() {
+	closeLooseStream();
 	delete _soundHandle;
 }
 
@@ -720,14 +806,28 @@ void AudioResourceManMusicItem::restart() {
 void AudioResourceManMusicItem::update() {
 
 	if (_start && !_vm->_mixer->isSoundHandleActive(*_soundHandle)) {
-		ResourceHandle resourceHandle;
-		_vm->_res->queryResource(_fileHash, resourceHandle);
-		Common::SeekableReadStream *stream = _vm->_res->createStream(_fileHash);
-		const byte *shiftValue = resourceHandle.extData();
-		NeverhoodAudioStream *audioStream = new NeverhoodAudioStream(22050, *shiftValue, true, DisposeAfterUse::YES, stream);
+		Audio::AudioStream *audioStream;
+		closeLooseStream();
+		_looseStream = _vm->_audioResourceMan->openLooseAudio(_fileHash);
+		if (_looseStream) {
+			_looseQueue = Audio::makeQueuingAudioStream(_looseStream->getRate(), _looseStream->isStereo());
+			fillLooseQueue();
+			audioStream = _looseQueue;
+		} else {
+			ResourceHandle resourceHandle;
+			_vm->_res->queryResource(_fileHash, resourceHandle);
+			Common::PrefetchingReadStream *stream = Common::wrapPrefetchingReadStream(_vm->_res->createStream(_fileHash),
+				kMusicChunkSize, kMusicChunkCount, DisposeAfterUse::YES);
+			if (stream)
+				stream->startBackgroundPrefetch();
+			const byte *shiftValue = resourceHandle.extData();
+			audioStream = new NeverhoodAudioStream(22050, *shiftValue, true, DisposeAfterUse::YES, stream);
+		}
 		_vm->_mixer->playStream(Audio::Mixer::kMusicSoundType, _soundHandle,
 			audioStream, -1, VOLUME(_isFadingIn ? _fadeVolume : _volume),
-			PANNING(_panning));
+			PANNING(_panning), _looseQueue ? DisposeAfterUse::NO : DisposeAfterUse::YES);
+		if (_looseQueue)
+			_vm->_audioResourceMan->addLooseMusic(this);
 		_start = false;
 		_isPlaying = true;
 	}
@@ -757,8 +857,43 @@ void AudioResourceManMusicItem::update() {
 
 }
 
+void AudioResourceManMusicItem::fillLooseQueue() {
+	const byte flags = Audio::FLAG_16BITS | (_looseStream->isStereo() ? Audio::FLAG_STEREO : 0)
+#ifdef SCUMM_LITTLE_ENDIAN
+		| Audio::FLAG_LITTLE_ENDIAN
+#endif
+		;
+
+	while (_looseQueue->numQueuedStreams() < kLooseQueuedBuffers) {
+		int16 *buffer = (int16 *)malloc(kLooseBufferSamples * sizeof(int16));
+		int samples = _looseStream->readBuffer(buffer, kLooseBufferSamples);
+		// Music loops, start over at the end of the track
+		if (samples < (int)kLooseBufferSamples && _looseStream->endOfData() && _looseStream->rewind())
+			samples += MAX(_looseStream->readBuffer(buffer + samples, kLooseBufferSamples - samples), 0);
+		if (samples <= 0) {
+			free(buffer);
+			break;
+		}
+		_looseQueue->queueBuffer((byte *)buffer, samples * sizeof(int16), DisposeAfterUse::YES, flags);
+	}
+}
+
+void AudioResourceManMusicItem::closeLooseStream() {
+	if (!_looseQueue)
+		return;
+	// The channel reads the queue until it is stopped
+	if (_vm->_mixer->isSoundHandleActive(*_soundHandle))
+		_vm->_mixer->stopHandle(*_soundHandle);
+	_vm->_audioResourceMan->removeLooseMusic(this);
+	delete _looseQueue;
+	delete _looseStream;
+	_looseStream = nullptr;
+	_looseQueue = nullptr;
+}
+
 AudioResourceMan::AudioResourceMan(NeverhoodEngine *vm)
-	: _vm(vm) {
+	: _vm(vm), _decodedSoundBytes(0) {
+	g_system->getTimerManager()->installTimerProc(&looseMusicTimerProc, 10000, this, "NeverhoodLooseMusic");
 }
 
 void AudioResourceMan::stopAllMusic() {
@@ -782,8 +917,11 @@ void AudioResourceMan::stopAllSounds() {
 }
 
 AudioResourceMan::~AudioResourceMan() {
+	g_system->getTimerManager()->removeTimerProc(&looseMusicTimerProc);
 	stopAllMusic();
 	stopAllSounds();
+	for (DecodedSoundMap::iterator it = _decodedSounds.begin(); it != _decodedSounds.end(); ++it)
+		delete it->_value;
 }
 
 int16 AudioResourceMan::addSound(uint32 fileHash) {
@@ -856,4 +994,88 @@ AudioResourceManMusicItem *AudioResourceMan::getMusicItem(int16 index) {
 	return (index >= 0 && index < (int16)_musicItems.size()) ? _musicItems[index] : NULL;
 }
 
+const DecodedSound *AudioResourceMan::getDecodedSound(uint32 fileHash, const byte *data, uint32 size, byte shiftValue) {
+	DecodedSoundMap::iterator it = _decodedSounds.find(fileHash);
+	if (it != _decodedSounds.end())
+		return it->_value;
+
+	const bool isCompressed = shiftValue != 0xFF;
+	const uint32 sampleCount = isCompressed ? size : size / 2;
+	const uint32 decodedBytes = sampleCount * sizeof(int16);
+	if (sampleCount == 0 || decodedBytes > kMaxDecodedSoundSize)
+		return nullptr;
+
+	// When the playing sounds fill the budget, the new one is decoded while
+	// it plays instead
+	purgeDecodedSounds(decodedBytes);
+	if (_decodedSoundBytes + decodedBytes > kMaxDecodedSoundBytes)
+		return nullptr;
+
+	DecodedSound *samples = new DecodedSound();
+	samples->resize(sampleCount);
+	if (isCompressed) {
+		int16 prevValue = 0;
+		decodeDeltaSamples(data, samples->begin(), sampleCount, prevValue, shiftValue);
+	} else {
+		for (uint32 i = 0; i < sampleCount; i++)
+			(*samples)[i] = READ_LE_UINT16(data + i * 2);
+	}
+
+	_decodedSounds[fileHash] = samples;
+	_decodedSoundBytes += decodedBytes;
+	debug(2, "AudioResourceMan::getDecodedSound() Decoded sound %08X, %d KB cached", fileHash, _decodedSoundBytes / 1024);
+	return samples;
+}
+
+bool AudioResourceMan::isSoundPlaying(uint32 fileHash) {
+	for (uint i = 0; i < _soundItems.size(); ++i)
+		if (_soundItems[i] && _soundItems[i]->getFileHash() == fileHash && _soundItems[i]->isPlaying())
+			return true;
+	return false;
+}
+
+void AudioResourceMan::purgeDecodedSounds(uint32 bytesNeeded) {
+	// Drop sounds which are not playing until the new one fits. A stopped
+	// sound has no stream left in the mixer which could still read it.
+	DecodedSoundMap::iterator it = _decodedSounds.begin();
+	while (_decodedSoundBytes + bytesNeeded > kMaxDecodedSoundBytes && it != _decodedSounds.end()) {
+		if (!isSoundPlaying(it->_key)) {
+			_decodedSoundBytes -= it->_value->size() * sizeof(int16);
+			delete it->_value;
+			_decodedSounds.erase(it++);
+		} else {
+			++it;
+		}
+	}
+}
+
+Audio::SeekableAudioStream *AudioResourceMan::openLooseAudio(uint32 fileHash) {
+	if (ConfigData::get()->looseDataFolder.empty() || _missingLooseAudio.contains(fileHash))
+		return nullptr;
+	Audio::SeekableAudioStream *stream = openLooseAudioFile(fileHash);
+	if (!stream)
+		_missingLooseAudio[fileHash] = true;
+	return stream;
+}
+
+void AudioResourceMan::addLooseMusic(AudioResourceManMusicItem *musicItem) {
+	Common::StackLock lock(_looseMutex);
+	_looseMusicItems.push_back(musicItem);
+}
+
+void AudioResourceMan::removeLooseMusic(AudioResourceManMusicItem *musicItem) {
+	Common::StackLock lock(_looseMutex);
+	_looseMusicItems.remove(musicItem);
+}
+
+void AudioResourceMan::looseMusicTimerProc(void *refCon) {
+	((AudioResourceMan *)refCon)->fillLooseQueues();
+}
+
+void AudioResourceMan::fillLooseQueues() {
+	Common::StackLock lock(_looseMutex);
+	for (Common::List<AudioResourceManMusicItem*>::iterator it = _looseMusicItems.begin(); it != _looseMusicItems.end(); ++it)
+		(*it)->fillLooseQueue();
+}
+
 } // End of namespace Neverhood
@@ -24,6 +24,9 @@
 
 #include "audio/audiostream.h"
 #include "common/array.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/mutex.h"
 #include "neverhood/resourceman.h"
 
 namespace Common {
@@ -207,6 +210,25 @@ private:
 	int fillBuffer(int maxSamples);
 };
 
+typedef Common::Array<int16> DecodedSound;
+
+// Plays samples decoded ahead of time. The samples belong to the decoded
+// sound cache of AudioResourceMan, which keeps them while they are playing.
+class NeverhoodDecodedAudioStream : public Audio::AudioStream {
+public:
+	NeverhoodDecodedAudioStream(int rate, bool isLooping, const DecodedSound *samples);
+	int readBuffer(int16 *buffer, const int numSamples) override;
+	bool isStereo() const override  { return false; }
+	bool endOfData() const override { return _endOfData; }
+	int getRate() const override { return _rate; }
+private:
+	const int _rate;
+	const bool _isLooping;
+	const DecodedSound *_samples;
+	uint32 _position;
+	bool _endOfData;
+};
+
 // TODO Rename these
 
 class AudioResourceManSoundItem {
@@ -220,6 +242,7 @@ public:
 	void playSound(bool looping);
 	void stopSound();
 	bool isPlaying();
+	uint32 getFileHash() const { return _fileHash; }
 protected:
 	NeverhoodEngine *_vm;
 	uint32 _fileHash;
@@ -260,6 +283,15 @@ protected:
 	int16 _fadeVolume;
 	int16 _fadeVolumeStep;
 	Audio::SoundHandle *_soundHandle;
+	// Replacement track from the loose data folder, decoded ahead of the
+	// mixer into a queue by the timer callback of AudioResourceMan. The queue
+	// is owned here, so that it outlives the channel until the callback lets
+	// go of it.
+	Audio::SeekableAudioStream *_looseStream;
+	Audio::QueuingAudioStream *_looseQueue;
+	void closeLooseStream();
+	friend class AudioResourceMan;
+	void fillLooseQueue();
 };
 
 class AudioResourceMan {
@@ -279,14 +311,39 @@ public:
 	AudioResourceManSoundItem *getSoundItem(int16 index);
 	AudioResourceManMusicItem *getMusicItem(int16 index);
 
+	const DecodedSound *getDecodedSound(uint32 fileHash, const byte *data, uint32 size, byte shiftValue);
+
+	Audio::SeekableAudioStream *openLooseAudio(uint32 fileHash);
+	void addLooseMusic(AudioResourceManMusicItem *musicItem);
+	void removeLooseMusic(AudioResourceManMusicItem *musicItem);
+
 protected:
 	NeverhoodEngine *_vm;
 
+	typedef Common::HashMap<uint32, DecodedSound*> DecodedSoundMap;
+	DecodedSoundMap _decodedSounds;
+	uint32 _decodedSoundBytes;
+	bool isSoundPlaying(uint32 fileHash);
+	void purgeDecodedSounds(uint32 bytesNeeded);
+
 	Common::Array<AudioResourceManMusicItem*> _musicItems;
 	Common::Array<AudioResourceManSoundItem*> _soundItems;
 
 	int16 addSoundItem(AudioResourceManSoundItem *soundItem);
 
+	// Hashes without a loose replacement, so that sounds which are played
+	// often do not go to the disk each time
+	typedef Common::HashMap<uint32, bool> LooseAudioMap;
+	LooseAudioMap _missingLooseAudio;
+
+	// The queues of the loose music items are refilled by a timer callback,
+	// off the main thread on most backends. _looseMutex guards the list and
+	// the streams of the items in it.
+	static void looseMusicTimerProc(void *refCon);
+	void fillLooseQueues();
+	Common::Mutex _looseMutex;
+	Common::List<AudioResourceManMusicItem*> _looseMusicItems;
+
 };
 
 } // End of namespace Neverhood
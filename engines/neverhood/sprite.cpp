@@ -77,7 +77,7 @@ void Sprite::setDoDeltaY(int type) {
 	_doDeltaY = type == 2 ? !_doDeltaY : type == 1;
 }
 
-bool Sprite::isPointInside(int16 x, int16 y) {
+bool Sprite::isPointInside(NCoord x, NCoord y) {
 	return x >= _collisionBounds.x1 && x <= _collisionBounds.x2 && y >= _collisionBounds.y1 && y <= _collisionBounds.y2;
 }
 
@@ -93,15 +93,15 @@ void Sprite::loadDataResource(uint32 fileHash) {
 	_dataResource.load(fileHash);
 }
 
-void Sprite::createSurface(int surfacePriority, int16 width, int16 height) {
+void Sprite::createSurface(int surfacePriority, NCoord width, NCoord height) {
 	_surface = new BaseSurface(_vm, surfacePriority, width, height, "sprite");
 }
 
-int16 Sprite::defFilterY(int16 y) {
+NCoord Sprite::defFilterY(NCoord y) {
 	return y - _vm->_screen->getYOffset();
 }
 
-void Sprite::setClipRect(int16 x1, int16 y1, int16 x2, int16 y2) {
+void Sprite::setClipRect(NCoord x1, NCoord y1, NCoord x2, NCoord y2) {
 	NRect &clipRect = _surface->getClipRect();
 	clipRect.x1 = x1;
 	clipRect.y1 = y1;
@@ -124,7 +124,7 @@ StaticSprite::StaticSprite(NeverhoodEngine *vm, int objectPriority)
 
 }
 
-StaticSprite::StaticSprite(NeverhoodEngine *vm, uint32 fileHash, int surfacePriority, int16 x, int16 y)
+StaticSprite::StaticSprite(NeverhoodEngine *vm, uint32 fileHash, int surfacePriority, NCoord x, NCoord y)
 	: Sprite(vm, 0), _spriteResource(vm) {
 
 	_spriteResource.load(fileHash, true);
@@ -136,7 +136,7 @@ StaticSprite::StaticSprite(NeverhoodEngine *vm, uint32 fileHash, int surfacePrio
 	updatePosition();
 }
 
-void StaticSprite::loadSprite(uint32 fileHash, uint flags, int surfacePriority, int16 x, int16 y) {
+void StaticSprite::loadSprite(uint32 fileHash, uint flags, int surfacePriority, NCoord x, NCoord y) {
 	_spriteResource.load(fileHash, true);
 	if (!_surface)
 		createSurface(surfacePriority, _spriteResource.getDimensions().width, _spriteResource.getDimensions().height);
@@ -196,7 +196,7 @@ AnimatedSprite::AnimatedSprite(NeverhoodEngine *vm, int objectPriority)
 	init();
 }
 
-AnimatedSprite::AnimatedSprite(NeverhoodEngine *vm, uint32 fileHash, int surfacePriority, int16 x, int16 y)
+AnimatedSprite::AnimatedSprite(NeverhoodEngine *vm, uint32 fileHash, int surfacePriority, NCoord x, NCoord y)
 	: Sprite(vm, 1100), _animResource(vm) {
 
 	init();
@@ -427,7 +427,7 @@ void AnimatedSprite::createShadowSurface1(BaseSurface *shadowSurface, uint32 fil
 	_surface = new ShadowSurface(_vm, surfacePriority, dimensions.width, dimensions.height, shadowSurface);
 }
 
-void AnimatedSprite::createShadowSurface(BaseSurface *shadowSurface, int16 width, int16 height, int surfacePriority) {
+void AnimatedSprite::createShadowSurface(BaseSurface *shadowSurface, NCoord width, NCoord height, int surfacePriority) {
 	_surface = new ShadowSurface(_vm, surfacePriority, width, height, shadowSurface);
 }
 
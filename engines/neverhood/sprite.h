@@ -38,17 +38,17 @@ namespace Neverhood {
 
 #define SetFilterX(callback)												\
 	do {																	\
-		_filterXCb = static_cast <int16 (Sprite::*)(int16)> (callback);		\
+		_filterXCb = static_cast <NCoord (Sprite::*)(NCoord)> (callback);	\
 		debug(2, "SetFilterX(" #callback ")");								\
 	} while (0)
 
 #define SetFilterY(callback)												\
 	do {																	\
-		_filterYCb = static_cast <int16 (Sprite::*)(int16)> (callback);		\
+		_filterYCb = static_cast <NCoord (Sprite::*)(NCoord)> (callback);	\
 		debug(2, "SetFilterY(" #callback ")");								\
 	} while (0)
 
-const int16 kDefPosition = -32768;
+const NCoord kDefPosition = -32768;
 
 class Sprite : public Entity {
 public:
@@ -59,35 +59,35 @@ public:
 	void updateBounds();
 	void setDoDeltaX(int type);
 	void setDoDeltaY(int type);
-	bool isPointInside(int16 x, int16 y);
+	bool isPointInside(NCoord x, NCoord y);
 	bool checkCollision(NRect &rect);
-	int16 getX() const { return _x; }
-	int16 getY() const { return _y; }
-	void setX(int16 value) { _x = value; }
-	void setY(int16 value) { _y = value; }
+	NCoord getX() const { return _x; }
+	NCoord getY() const { return _y; }
+	void setX(NCoord value) { _x = value; }
+	void setY(NCoord value) { _y = value; }
 	uint16 getFlags() const { return _flags; }
 	bool isDoDeltaX() const { return _doDeltaX; }
 	bool isDoDeltaY() const { return _doDeltaY; }
 	NRect& getCollisionBounds() { return _collisionBounds; }
 	uint32 handleMessage(int messageNum, const MessageParam &param, Entity *sender);
 	void loadDataResource(uint32 fileHash);
-	int16 defFilterY(int16 y);
+	NCoord defFilterY(NCoord y);
 	bool getVisible() const { return _surface->getVisible(); }
 	void setVisible(bool value) { _surface->setVisible(value); }
 	NDrawRect& getDrawRect() { return _surface->getDrawRect(); }
 	// Some shortcuts to set the clipRect
 	NRect& getClipRect() { return _surface->getClipRect(); }
-	void setClipRect(int16 x1, int16 y1, int16 x2, int16 y2);
+	void setClipRect(NCoord x1, NCoord y1, NCoord x2, NCoord y2);
 	void setClipRect(NRect& clipRect);
 	void setClipRect(NDrawRect& drawRect);
 
 protected:
 	void (Sprite::*_spriteUpdateCb)();
 	Common::String _spriteUpdateCbName; // For debugging purposes
-	int16 (Sprite::*_filterXCb)(int16);
-	int16 (Sprite::*_filterYCb)(int16);
+	NCoord (Sprite::*_filterXCb)(NCoord);
+	NCoord (Sprite::*_filterYCb)(NCoord);
 	BaseSurface *_surface;
-	int16 _x, _y;
+	NCoord _x, _y;
 	bool _doDeltaX, _doDeltaY;
 	bool _needRefresh;
 	NDrawRect _drawOffset;
@@ -96,15 +96,15 @@ protected:
 	uint16 _flags;
 	DataResource _dataResource;
 
-	void createSurface(int surfacePriority, int16 width, int16 height);
+	void createSurface(int surfacePriority, NCoord width, NCoord height);
 	void handleSpriteUpdate() {
 		if (_spriteUpdateCb)
 			(this->*_spriteUpdateCb)();
 	}
-	int16 filterX(int16 x) {
+	NCoord filterX(NCoord x) {
 		return _filterXCb ? (this->*_filterXCb)(x) : x;
 	}
-	int16 filterY(int16 y) {
+	NCoord filterY(NCoord y) {
 		return _filterYCb ? (this->*_filterYCb)(y) : y;
 	}
 
@@ -124,8 +124,8 @@ enum {
 class StaticSprite : public Sprite {
 public:
 	StaticSprite(NeverhoodEngine *vm, int objectPriority);
-	StaticSprite(NeverhoodEngine *vm, uint32 fileHash, int surfacePriority, int16 x = kDefPosition, int16 y = kDefPosition);
-	void loadSprite(uint32 fileHash, uint flags = 0, int surfacePriority = 0, int16 x = kDefPosition, int16 y = kDefPosition);
+	StaticSprite(NeverhoodEngine *vm, uint32 fileHash, int surfacePriority, NCoord x = kDefPosition, NCoord y = kDefPosition);
+	void loadSprite(uint32 fileHash, uint flags = 0, int surfacePriority = 0, NCoord x = kDefPosition, NCoord y = kDefPosition);
 	void updatePosition();
 	uint32 getFileHash() const;
 protected:
@@ -146,7 +146,7 @@ const int STICK_LAST_FRAME = -2;
 class AnimatedSprite : public Sprite {
 public:
 	AnimatedSprite(NeverhoodEngine *vm, int objectPriority);
-	AnimatedSprite(NeverhoodEngine *vm, uint32 fileHash, int surfacePriority, int16 x, int16 y);
+	AnimatedSprite(NeverhoodEngine *vm, uint32 fileHash, int surfacePriority, NCoord x, NCoord y);
 	void update();
 	void updateDeltaXY();
 	void setRepl(byte oldColor, byte newColor);
@@ -167,7 +167,7 @@ protected:
 	int16 _currFrameTicks;
 	int _currStickFrameIndex, _newStickFrameIndex;
 	uint32 _newStickFrameHash;
-	int16 _deltaX, _deltaY;
+	NCoord _deltaX, _deltaY;
 	byte _replOldColor, _replNewColor;
 	bool _playBackwards, _frameChanged;
 	AnimationCb _finalizeStateCb;
@@ -184,7 +184,7 @@ protected:
 	void updateFrameInfo();
 	void createSurface1(uint32 fileHash, int surfacePriority);
 	void createShadowSurface1(BaseSurface *shadowSurface, uint32 fileHash, int surfacePriority);
-	void createShadowSurface(BaseSurface *shadowSurface, int16 width, int16 height, int surfacePriority);
+	void createShadowSurface(BaseSurface *shadowSurface, NCoord width, NCoord height, int surfacePriority);
 	void stopAnimation();
 	void startAnimationByHash(uint32 fileHash, uint32 plFirstFrameHash, uint32 plLastFrameHash);
 	void nextAnimationByHash(uint32 fileHash2, uint32 plFirstFrameHash, uint32 plLastFrameHash);
@@ -0,0 +1,105 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/textconsole.h"
+#include "neverhood/surfacepool.h"
+
+namespace Neverhood {
+
+SurfacePool::SurfacePool(uint32 maxPooledBytes)
+	: _maxPooledBytes(maxPooledBytes) {
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+SurfacePool::~SurfacePool() {
+	purge();
+	if (_stats.bytesInUse > 0)
+		warning("SurfacePool::~SurfacePool() %u bytes still in use", _stats.bytesInUse);
+}
+
+uint32 SurfacePool::getSizeClass(uint32 size) {
+	// Round up to a quarter of the next lower power of two, this wastes at
+	// most 25% while letting surfaces of similar sizes share buffers
+	if (size <= 4096)
+		return 4096;
+	uint32 step = 1;
+	while (step <= size / 2)
+		step <<= 1;
+	step >>= 2;
+	return (size + step - 1) & ~(step - 1);
+}
+
+byte *SurfacePool::allocate(uint32 size) {
+	if (size == 0)
+		return nullptr;
+
+	const uint32 sizeClass = getSizeClass(size);
+	byte *buffer = nullptr;
+
+	_stats.requests++;
+
+	BufferMap::iterator it = _freeBuffers.find(sizeClass);
+	if (it != _freeBuffers.end() && !it->_value.empty()) {
+		buffer = it->_value.back();
+		it->_value.pop_back();
+		_stats.bytesPooled -= sizeClass;
+		_stats.reused++;
+		memset(buffer, 0, size);
+	} else {
+		buffer = (byte *)calloc(sizeClass, 1);
+		if (!buffer)
+			error("SurfacePool::allocate() Could not allocate %u bytes", sizeClass);
+	}
+
+	_stats.bytesInUse += sizeClass;
+	_stats.peakBytesInUse = MAX(_stats.peakBytesInUse, _stats.bytesInUse);
+	return buffer;
+}
+
+void SurfacePool::release(byte *buffer, uint32 size) {
+	if (!buffer)
+		return;
+
+	const uint32 sizeClass = getSizeClass(size);
+
+	_stats.bytesInUse -= sizeClass;
+	_stats.released++;
+
+	if (_stats.bytesPooled + sizeClass > _maxPooledBytes) {
+		free(buffer);
+		_stats.discarded++;
+		return;
+	}
+
+	_freeBuffers[sizeClass].push_back(buffer);
+	_stats.bytesPooled += sizeClass;
+}
+
+void SurfacePool::purge() {
+	for (BufferMap::iterator it = _freeBuffers.begin(); it != _freeBuffers.end(); ++it) {
+		for (BufferList::iterator bt = it->_value.begin(); bt != it->_value.end(); ++bt)
+			free(*bt);
+	}
+	_freeBuffers.clear();
+	_stats.bytesPooled = 0;
+}
+
+} // End of namespace Neverhood
@@ -0,0 +1,73 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NEVERHOOD_SURFACEPOOL_H
+#define NEVERHOOD_SURFACEPOOL_H
+
+#include "common/array.h"
+#include "common/hashmap.h"
+
+namespace Neverhood {
+
+/**
+ * Recycles the pixel buffers of BaseSurface objects. Buffers are rounded up
+ * to size classes, so a surface of a similar size in the next scene can take
+ * over a buffer released by the previous one instead of going back to the
+ * system allocator.
+ */
+class SurfacePool {
+public:
+	struct Stats {
+		uint32 requests;
+		uint32 reused;
+		uint32 released;
+		uint32 discarded;
+		uint32 bytesInUse;
+		uint32 peakBytesInUse;
+		uint32 bytesPooled;
+	};
+
+	SurfacePool(uint32 maxPooledBytes);
+	~SurfacePool();
+
+	/** Returns a zero-filled buffer of at least the given size. */
+	byte *allocate(uint32 size);
+	/** Returns a buffer obtained from allocate() to the pool. */
+	void release(byte *buffer, uint32 size);
+	/** Frees all buffers that are not in use. */
+	void purge();
+
+	const Stats &getStats() const { return _stats; }
+
+protected:
+	typedef Common::Array<byte *> BufferList;
+	typedef Common::HashMap<uint32, BufferList> BufferMap;
+
+	uint32 _maxPooledBytes;
+	BufferMap _freeBuffers;
+	Stats _stats;
+
+	static uint32 getSizeClass(uint32 size);
+};
+
+} // End of namespace Neverhood
+
+#endif /* NEVERHOOD_SURFACEPOOL_H */
@@ -0,0 +1,108 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NEVERHOOD_THUMBNAIL_H
+#define NEVERHOOD_THUMBNAIL_H
+
+#include "common/scummsys.h"
+#include "common/util.h"
+#include "graphics/pixelformat.h"
+#include "neverhood/simd.h"
+
+namespace Neverhood {
+
+/**
+ * Adds one row of 32bpp pixels to the box filter sums of the thumbnail.
+ * Thumbnail column tx covers the source pixels columns[tx] up to
+ * columns[tx + 1] - 1. sums holds the red, green and blue sum of each of
+ * the count columns.
+ */
+inline void sumThumbnailRowScalar(const byte *source, const int *columns, int count, const Graphics::PixelFormat &format, uint32 *sums) {
+	const uint32 *pixels = (const uint32 *)source;
+	for (int tx = 0; tx < count; tx++, sums += 3) {
+		for (int sx = columns[tx]; sx < columns[tx + 1]; sx++) {
+			uint8 a, r, g, b;
+			format.colorToARGB(pixels[sx], a, r, g, b);
+			sums[0] += r;
+			sums[1] += g;
+			sums[2] += b;
+		}
+	}
+}
+
+#ifdef NEVERHOOD_SSE2
+
+inline bool canSumThumbnailRowSSE2(const Graphics::PixelFormat &format) {
+	return format.bytesPerPixel == 4 && format.rLoss == 0 && format.gLoss == 0 && format.bLoss == 0 &&
+		format.rShift % 8 == 0 && format.gShift % 8 == 0 && format.bShift % 8 == 0;
+}
+
+/**
+ * Same as sumThumbnailRowScalar(), for formats accepted by
+ * canSumThumbnailRowSSE2(). Four pixels are widened to 16-bit lanes and
+ * summed at a time.
+ */
+inline void sumThumbnailRowSSE2(const byte *source, const int *columns, int count, const Graphics::PixelFormat &format, uint32 *sums) {
+	// A 16-bit lane gets two pixels per step of 4 pixels, so it holds the
+	// sum of 128 steps
+	const int kMaxBlockPixels = 4 * 128;
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int tx = 0; tx < count; tx++, sums += 3) {
+		uint32 lanes[4] = { 0, 0, 0, 0 };
+		int sx = columns[tx];
+		const int end = columns[tx + 1];
+		while (end - sx >= 4) {
+			const int blockEnd = sx + MIN((end - sx) & ~3, kMaxBlockPixels);
+			__m128i acc = zero;
+			for (; sx < blockEnd; sx += 4) {
+				const __m128i v = _mm_loadu_si128((const __m128i *)(source + sx * 4));
+				acc = _mm_add_epi16(acc, _mm_add_epi16(_mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero)));
+			}
+			uint32 blockLanes[4];
+			_mm_storeu_si128((__m128i *)blockLanes, _mm_add_epi32(_mm_unpacklo_epi16(acc, zero), _mm_unpackhi_epi16(acc, zero)));
+			for (int i = 0; i < 4; i++)
+				lanes[i] += blockLanes[i];
+		}
+		for (; sx < end; sx++)
+			for (int i = 0; i < 4; i++)
+				lanes[i] += source[sx * 4 + i];
+		sums[0] += lanes[format.rShift / 8];
+		sums[1] += lanes[format.gShift / 8];
+		sums[2] += lanes[format.bShift / 8];
+	}
+}
+
+#endif
+
+inline void sumThumbnailRow(const byte *source, const int *columns, int count, const Graphics::PixelFormat &format, uint32 *sums) {
+#ifdef NEVERHOOD_SSE2
+	if (canSumThumbnailRowSSE2(format)) {
+		sumThumbnailRowSSE2(source, columns, count, format, sums);
+		return;
+	}
+#endif
+	sumThumbnailRowScalar(source, columns, count, format, sums);
+}
+
+} // End of namespace Neverhood
+
+#endif /* NEVERHOOD_THUMBNAIL_H */
@@ -30,6 +30,7 @@
 
 #include "image/png.h"
 
+#include "graphics/conversion.h"
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
@@ -300,6 +301,110 @@ bool PNGDecoder::loadStream(Common::SeekableReadStream &stream) {
 #endif
 }
 
+bool PNGDecoder::loadStreamInto(Common::SeekableReadStream &stream, Graphics::Surface &dst,
+		const Graphics::PixelFormat &format, uint32 pitchAlign, OutputBuffer &outputBuffer) {
+#ifdef USE_PNG
+	destroy();
+
+	if (format.bytesPerPixel != 2 && format.bytesPerPixel != 4)
+		return false;
+
+	if (!_skipSignature) {
+		if (stream.readUint32BE() != MKTAG(0x89, 'P', 'N', 'G')) {
+			return false;
+		}
+		if (stream.readUint32BE() != MKTAG(0x0d, 0x0a, 0x1a, 0x0a)) {
+			return false;
+		}
+	}
+
+	png_structp pngPtr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if (!pngPtr) {
+		return false;
+	}
+	png_infop infoPtr = png_create_info_struct(pngPtr);
+	if (!infoPtr) {
+		png_destroy_read_struct(&pngPtr, NULL, NULL);
+		return false;
+	}
+
+	png_set_error_fn(pngPtr, NULL, pngError, pngWarning);
+	png_set_read_fn(pngPtr, &stream, pngReadFromStream);
+	png_set_crc_action(pngPtr, PNG_CRC_DEFAULT, PNG_CRC_WARN_USE);
+	png_set_sig_bytes(pngPtr, 8);
+
+	png_read_info(pngPtr, infoPtr);
+
+	int bitDepth, colorType, interlaceType;
+	png_uint_32 w, h;
+	png_get_IHDR(pngPtr, infoPtr, &w, &h, &bitDepth, &colorType, &interlaceType, NULL, NULL);
+	const bool hasTransparency = png_get_valid(pngPtr, infoPtr, PNG_INFO_tRNS);
+
+	// Let libpng expand every color type to 8-bit RGBA in byte order
+	if (colorType == PNG_COLOR_TYPE_PALETTE || bitDepth < 8 || hasTransparency)
+		png_set_expand(pngPtr);
+	if (bitDepth == 16)
+		png_set_strip_16(pngPtr);
+	if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
+		png_set_gray_to_rgb(pngPtr);
+	if (!(colorType & PNG_COLOR_MASK_ALPHA) && !hasTransparency)
+		png_set_filler(pngPtr, 0xff, PNG_FILLER_AFTER);
+
+	const int passes = png_set_interlace_handling(pngPtr);
+	png_read_update_info(pngPtr, infoPtr);
+
+	const int width = w;
+	const int height = h;
+	const Graphics::PixelFormat rgbaFormat = getByteOrderRgbaPixelFormat(true);
+	const uint32 rgbaPitch = width * 4;
+	const uint32 pitch = (width * format.bytesPerPixel + pitchAlign - 1) / pitchAlign * pitchAlign;
+
+	byte *pixels = outputBuffer.allocate(width, height, pitch);
+	if (!pixels) {
+		png_destroy_read_struct(&pngPtr, &infoPtr, NULL);
+		return false;
+	}
+	dst.init(width, height, pitch, pixels, format);
+
+	// Formats differing only in the alpha channel share the same byte layout
+	const bool isDirect = format.bytesPerPixel == 4 &&
+		format.rShift == rgbaFormat.rShift && format.gShift == rgbaFormat.gShift && format.bShift == rgbaFormat.bShift &&
+		(format.aLoss == 8 || format.aShift == rgbaFormat.aShift);
+
+	if (passes == 1 && isDirect) {
+		for (int y = 0; y < height; y++)
+			png_read_row(pngPtr, (png_bytep)dst.getBasePtr(0, y), NULL);
+	} else if (passes == 1) {
+		// Convert row by row while the decoded row is still in the cache
+		byte *row = new byte[rgbaPitch];
+		for (int y = 0; y < height; y++) {
+			png_read_row(pngPtr, row, NULL);
+			Graphics::crossBlit((byte *)dst.getBasePtr(0, y), row, pitch, rgbaPitch, width, 1, format, rgbaFormat);
+		}
+		delete[] row;
+	} else {
+		// Interlaced images need all rows available for every pass
+		byte *image = isDirect ? nullptr : new byte[rgbaPitch * height];
+		png_bytep *rowPtr = new png_bytep[height];
+		for (int y = 0; y < height; y++)
+			rowPtr[y] = isDirect ? (png_bytep)dst.getBasePtr(0, y) : image + y * rgbaPitch;
+		png_read_image(pngPtr, rowPtr);
+		delete[] rowPtr;
+		if (image) {
+			Graphics::crossBlit(pixels, image, pitch, rgbaPitch, width, height, format, rgbaFormat);
+			delete[] image;
+		}
+	}
+
+	png_read_end(pngPtr, NULL);
+	png_destroy_read_struct(&pngPtr, &infoPtr, NULL);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
 bool writePNG(Common::WriteStream &out, const Graphics::Surface &input, const byte *palette) {
 #ifdef USE_PNG
 #ifdef SCUMM_LITTLE_ENDIAN
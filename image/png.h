@@ -54,10 +54,45 @@ namespace Image {
 
 class PNGDecoder : public ImageDecoder {
 public:
+	/**
+	 * Provides the destination memory for loadStreamInto().
+	 */
+	class OutputBuffer {
+	public:
+		virtual ~OutputBuffer() {}
+
+		/**
+		 * Return a buffer large enough for @p height rows of @p pitch bytes,
+		 * or nullptr to abort decoding. The buffer is owned by the caller.
+		 */
+		virtual byte *allocate(uint16 width, uint16 height, uint32 pitch) = 0;
+	};
+
 	PNGDecoder();
 	~PNGDecoder();
 
 	bool loadStream(Common::SeekableReadStream &stream) override;
+
+	/**
+	 * Decode an image straight into caller-owned memory.
+	 *
+	 * Unlike loadStream(), no surface is allocated by the decoder and
+	 * getSurface() stays empty. Rows are converted to @p format as they
+	 * are decoded, so no separate conversion pass over the image is needed.
+	 * Paletted images are expanded to true color.
+	 *
+	 * @param stream        Input stream.
+	 * @param dst           Receives the decoded image, its pixels point into
+	 *                      the memory returned by @p outputBuffer.
+	 * @param format        Requested destination format, 2 or 4 bytes per pixel.
+	 * @param pitchAlign    Alignment in bytes of each destination row.
+	 * @param outputBuffer  Provider of the destination memory.
+	 *
+	 * @return Whether loading the file succeeded.
+	 */
+	bool loadStreamInto(Common::SeekableReadStream &stream, Graphics::Surface &dst,
+		const Graphics::PixelFormat &format, uint32 pitchAlign, OutputBuffer &outputBuffer);
+
 	void destroy() override;
 	const Graphics::Surface *getSurface() const override { return _outputSurface; }
 	const byte *getPalette() const override { return _palette; }
@@ -0,0 +1,160 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/*
+ * QOI decoder based on the format specification at https://qoiformat.org/
+ */
+
+#include "image/qoi.h"
+
+#include "common/stream.h"
+#include "common/textconsole.h"
+
+namespace Image {
+
+enum {
+	kQOIHeaderSize  = 14,
+	kQOIPaddingSize = 8,
+
+	kQOIOpIndex = 0x00,
+	kQOIOpDiff  = 0x40,
+	kQOIOpLuma  = 0x80,
+	kQOIOpRun   = 0xc0,
+	kQOIOpRGB   = 0xfe,
+	kQOIOpRGBA  = 0xff,
+	kQOIMask2   = 0xc0
+};
+
+QOIDecoder::QOIDecoder() {
+}
+
+QOIDecoder::~QOIDecoder() {
+	destroy();
+}
+
+void QOIDecoder::destroy() {
+	_surface.free();
+}
+
+bool QOIDecoder::loadStream(Common::SeekableReadStream &stream) {
+	destroy();
+
+	if (stream.readUint32BE() != MKTAG('q', 'o', 'i', 'f'))
+		return false;
+
+	const uint32 width = stream.readUint32BE();
+	const uint32 height = stream.readUint32BE();
+	const byte channels = stream.readByte();
+	stream.readByte(); // colorspace, informative only
+
+	if (stream.err() || width == 0 || height == 0 || width > 0x7FFF || height > 0x7FFF ||
+		(channels != 3 && channels != 4)) {
+		warning("QOIDecoder: Invalid header");
+		return false;
+	}
+
+	// The chunk data is read in one go, decoding from memory avoids
+	// a virtual stream call per pixel
+	const uint32 dataSize = stream.size() - stream.pos();
+	byte *data = new byte[dataSize];
+	if (stream.read(data, dataSize) != dataSize) {
+		delete[] data;
+		return false;
+	}
+
+#ifdef SCUMM_BIG_ENDIAN
+	_surface.create(width, height, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+#else
+	_surface.create(width, height, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24));
+#endif
+
+	const bool success = decodeData(data, dataSize);
+	delete[] data;
+
+	if (!success) {
+		warning("QOIDecoder: Truncated image data");
+		destroy();
+	}
+
+	return success;
+}
+
+bool QOIDecoder::decodeData(const byte *data, uint32 dataSize) {
+	byte index[64 * 4];
+	byte px[4] = { 0, 0, 0, 255 };
+	int run = 0;
+
+	memset(index, 0, sizeof(index));
+
+	const byte *src = data;
+	const byte *srcEnd = data + (dataSize > kQOIPaddingSize ? dataSize - kQOIPaddingSize : 0);
+
+	for (int y = 0; y < _surface.h; y++) {
+		byte *dst = (byte *)_surface.getBasePtr(0, y);
+		for (int x = 0; x < _surface.w; x++, dst += 4) {
+			if (run > 0) {
+				run--;
+			} else {
+				if (src >= srcEnd)
+					return false;
+
+				const byte b1 = *src++;
+
+				if (b1 == kQOIOpRGB) {
+					px[0] = src[0];
+					px[1] = src[1];
+					px[2] = src[2];
+					src += 3;
+				} else if (b1 == kQOIOpRGBA) {
+					px[0] = src[0];
+					px[1] = src[1];
+					px[2] = src[2];
+					px[3] = src[3];
+					src += 4;
+				} else if ((b1 & kQOIMask2) == kQOIOpIndex) {
+					memcpy(px, &index[b1 * 4], 4);
+				} else if ((b1 & kQOIMask2) == kQOIOpDiff) {
+					px[0] += ((b1 >> 4) & 0x03) - 2;
+					px[1] += ((b1 >> 2) & 0x03) - 2;
+					px[2] += (b1 & 0x03) - 2;
+				} else if ((b1 & kQOIMask2) == kQOIOpLuma) {
+					const byte b2 = *src++;
+					const int vg = (b1 & 0x3f) - 32;
+					px[0] += vg - 8 + ((b2 >> 4) & 0x0f);
+					px[1] += vg;
+					px[2] += vg - 8 + (b2 & 0x0f);
+				} else {
+					run = b1 & 0x3f;
+				}
+
+				const int hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+				memcpy(&index[hash * 4], px, 4);
+			}
+
+			memcpy(dst, px, 4);
+		}
+	}
+
+	return true;
+}
+
+} // End of namespace Image
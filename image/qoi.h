@@ -0,0 +1,68 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef IMAGE_QOI_H
+#define IMAGE_QOI_H
+
+#include "graphics/surface.h"
+#include "image/image_decoder.h"
+
+namespace Common {
+class SeekableReadStream;
+}
+
+namespace Image {
+
+/**
+ * @defgroup image_qoi QOI decoder
+ * @ingroup image
+ *
+ * @brief Decoder for QOI ("Quite OK Image") images.
+ *
+ * QOI is a lossless RGB/RGBA format which decodes in a single pass
+ * without any entropy coding, which makes it considerably cheaper to
+ * load than PNG for large true-color images.
+ *
+ * Used in engines:
+ * - Neverhood
+ * @{
+ */
+
+class QOIDecoder : public ImageDecoder {
+public:
+	QOIDecoder();
+	~QOIDecoder() override;
+
+	bool loadStream(Common::SeekableReadStream &stream) override;
+	void destroy() override;
+	const Graphics::Surface *getSurface() const override { return &_surface; }
+
+private:
+	Graphics::Surface _surface;
+
+	bool decodeData(const byte *data, uint32 dataSize);
+};
+
+/** @} */
+} // End of namespace Image
+
+#endif
@@ -0,0 +1,144 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/raw.h"
+
+#include "helper.h"
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+private:
+	Audio::SoundHandle playSine(Audio::Mixer &mixer) {
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, &sine, false, false);
+		delete[] sine;
+
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kSFXSoundType, &handle, s, -1, Audio::Mixer::kMaxChannelVolume, 0);
+		return handle;
+	}
+
+public:
+	void test_queued_volume() {
+		Audio::MixerImpl mixer(11025);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle = playSine(mixer);
+		TS_ASSERT(mixer.isSoundHandleActive(handle));
+
+		// Visible right away, applied by the next mix pass
+		mixer.setChannelVolume(handle, 64);
+		mixer.setChannelBalance(handle, -20);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 64);
+		TS_ASSERT_EQUALS(mixer.getChannelBalance(handle), -20);
+		TS_ASSERT_EQUALS(mixer.getCommandStats().queued, 2u);
+
+		int16 buffer[512 * 2];
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT_EQUALS(mixer.getCommandStats().applied, 2u);
+		TS_ASSERT_EQUALS(mixer.getCommandStats().maxQueueDepth, 2u);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 64);
+
+		mixer.stopHandle(handle);
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 0);
+
+		// Commands for stopped sounds are dropped
+		mixer.setChannelVolume(handle, 32);
+		TS_ASSERT_EQUALS(mixer.getCommandStats().queued, 2u);
+	}
+
+	void test_queue_overflow() {
+		Audio::MixerImpl mixer(11025);
+		mixer.setReady(true);
+
+		// Fill the command queue, which holds 64 commands
+		Audio::SoundHandle handle = playSine(mixer);
+		for (int i = 0; i < 64; i++)
+			mixer.setChannelVolume(handle, Audio::Mixer::kMaxChannelVolume);
+
+		// The queue is full, the older commands must not win over this one
+		mixer.setChannelVolume(handle, 0);
+		TS_ASSERT_EQUALS(mixer.getCommandStats().overflows, 1u);
+		TS_ASSERT_EQUALS(mixer.getCommandStats().applied, 64u);
+		// Flushing the queue early is no mix pass
+		TS_ASSERT_EQUALS(mixer.getCommandStats().mixPasses, 0u);
+		TS_ASSERT_EQUALS(mixer.getCommandStats().maxQueueDepth, 0u);
+
+		int16 buffer[512 * 2];
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT_EQUALS(mixer.getCommandStats().mixPasses, 1u);
+		bool silent = true;
+		for (int i = 0; i < 512 * 2; i++)
+			silent = silent && buffer[i] == 0;
+		TS_ASSERT(silent);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 0);
+	}
+
+	void test_finished_sound_inactive() {
+		Audio::MixerImpl mixer(11025);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle = playSine(mixer);
+		int16 buffer[4096 * 2];
+		// The channel is reaped on the mix pass after its stream ended
+		for (int i = 0; i < 8 && mixer.isSoundHandleActive(handle); i++)
+			mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+	}
+
+	void test_stats() {
+		Audio::MixerImpl mixer(11025);
+		mixer.setReady(true);
+
+		playSine(mixer);
+
+		// A queue which is not finished but runs dry is an underrun
+		Audio::QueuingAudioStream *queue = Audio::makeQueuingAudioStream(11025, false);
+		byte *silence = (byte *)calloc(100, 2);
+		queue->queueBuffer(silence, 200, DisposeAfterUse::YES, Audio::FLAG_16BITS);
+		Audio::SoundHandle queueHandle;
+		Audio::Mixer &base = mixer;
+		base.playStream(Audio::Mixer::kMusicSoundType, &queueHandle, queue);
+
+		int16 buffer[512 * 2];
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+
+		Audio::Mixer::Stats stats;
+		mixer.getStats(stats);
+		TS_ASSERT_EQUALS(stats.callbacks, 1u);
+		TS_ASSERT_EQUALS(stats.underruns, 1u);
+		TS_ASSERT_EQUALS(stats.bufferPeriod, 512u * 1000000 / 11025);
+		TS_ASSERT_EQUALS(stats.activeStreams[Audio::Mixer::kSFXSoundType], 1u);
+		TS_ASSERT_EQUALS(stats.activeStreams[Audio::Mixer::kMusicSoundType], 1u);
+		TS_ASSERT_EQUALS(stats.channels.size(), 2u);
+		for (uint i = 0; i < stats.channels.size(); i++) {
+			TS_ASSERT_EQUALS(stats.channels[i].mixPasses, 1u);
+			TS_ASSERT_EQUALS(stats.channels[i].underruns, stats.channels[i].type == Audio::Mixer::kMusicSoundType ? 1u : 0u);
+		}
+
+		// Without timing the clock is never read
+		TS_ASSERT(!mixer.isTimingEnabled());
+		TS_ASSERT_EQUALS(stats.maxCallbackTime, 0u);
+		TS_ASSERT_EQUALS(stats.channels[0].mixTime, 0u);
+
+		mixer.resetStats();
+		mixer.getStats(stats);
+		TS_ASSERT_EQUALS(stats.callbacks, 0u);
+		TS_ASSERT_EQUALS(stats.underruns, 0u);
+		TS_ASSERT_EQUALS(stats.channels[0].mixPasses, 0u);
+
+		// Enabling timing starts over
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		mixer.setTimingEnabled(true);
+		mixer.getStats(stats);
+		TS_ASSERT_EQUALS(stats.callbacks, 0u);
+		mixer.mixCallback((byte *)buffer, sizeof(buffer));
+		mixer.getStats(stats);
+		TS_ASSERT_EQUALS(stats.callbacks, 1u);
+		TS_ASSERT_EQUALS(stats.lateCallbacks, 0u);
+
+		queue->finish();
+	}
+};
@@ -0,0 +1,134 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/rate.h"
+#include "audio/mixer.h"
+#include "audio/decoders/raw.h"
+
+#include "helper.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	// The 32-bit bus path must give the same samples as the 16-bit one
+	void compareBus(int inRate, int outRate, bool stereo, bool reverseStereo, Audio::st_volume_t volL, Audio::st_volume_t volR, const Audio::SincFilter *filter = nullptr) {
+		int16 *sine;
+		Audio::SeekableAudioStream *s16 = createSineStream<int16>(inRate, 1, &sine, false, stereo);
+		Audio::SeekableAudioStream *s32 = createSineStream<int16>(inRate, 1, nullptr, false, stereo);
+		delete[] sine;
+
+		Audio::RateConverter *c16 = Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo, filter);
+		Audio::RateConverter *c32 = Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo, filter);
+
+		// An odd length exercises the scalar tails
+		const int frames = 1021;
+		int16 out16[frames * 2], out32[frames * 2];
+		int32 bus[frames * 2];
+
+		for (int pass = 0; pass < 4; pass++) {
+			memset(out16, 0, sizeof(out16));
+			memset(bus, 0, sizeof(bus));
+
+			const int n16 = c16->flow(*s16, out16, frames, volL, volR);
+			const int n32 = c32->flow(*s32, bus, frames, volL, volR);
+			TS_ASSERT_EQUALS(n16, n32);
+
+			Audio::saturateBus(out32, bus, frames * 2);
+			TS_ASSERT_SAME_DATA(out16, out32, n16 * 2 * sizeof(int16));
+		}
+
+		delete c16;
+		delete c32;
+		delete s16;
+		delete s32;
+	}
+
+public:
+	void test_copy_bus() {
+		compareBus(11025, 11025, false, false, 200, 100);
+		compareBus(11025, 11025, true, false, 256, 37);
+		compareBus(11025, 11025, true, true, 13, 255);
+	}
+
+	void test_linear_bus() {
+		compareBus(11025, 22050, false, false, 256, 128);
+		compareBus(22050, 44100, true, false, 77, 256);
+		compareBus(22050, 48000, true, true, 255, 1);
+	}
+
+	void test_simple_bus() {
+		compareBus(22050, 11025, true, false, 180, 90);
+	}
+
+	void test_sinc_bus() {
+		Audio::SincFilter medium(22050, 48000, Audio::kRateQualityMedium);
+		compareBus(22050, 48000, false, false, 256, 200, &medium);
+		compareBus(22050, 48000, true, true, 100, 256, &medium);
+
+		Audio::SincFilter high(11025, 44100, Audio::kRateQualityHigh);
+		compareBus(11025, 44100, true, false, 256, 256, &high);
+	}
+
+	void test_sinc_filter() {
+		TS_ASSERT(Audio::SincFilter::isSupported(22050, 48000));
+		TS_ASSERT(Audio::SincFilter::isSupported(11025, 48000));
+		TS_ASSERT(!Audio::SincFilter::isSupported(44100, 22050));
+		TS_ASSERT(!Audio::SincFilter::isSupported(22050, 22050));
+		TS_ASSERT(!Audio::SincFilter::isSupported(22051, 48000));
+
+		Audio::SincFilter filter(22050, 48000, Audio::kRateQualityHigh);
+		TS_ASSERT_EQUALS(filter.getPhases(), 320);
+		TS_ASSERT_EQUALS(filter.getStep(), 147);
+		TS_ASSERT_EQUALS(filter.getTaps(), 32);
+
+		// Every phase has unity gain, up to rounding
+		for (int phase = 0; phase < filter.getPhases(); phase++) {
+			const int16 *coeffs = filter.getCoefficients(phase);
+			int sum = 0;
+			for (int k = 0; k < filter.getTaps(); k++)
+				sum += coeffs[k];
+			TS_ASSERT_DELTA(sum, 16384, filter.getTaps() / 2);
+		}
+	}
+
+	void test_sinc_dc() {
+		const int inFrames = 22050;
+		int16 *samples = (int16 *)malloc(inFrames * sizeof(int16));
+		for (int i = 0; i < inFrames; i++)
+			samples[i] = 10000;
+#ifdef SCUMM_LITTLE_ENDIAN
+		const byte flags = Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN;
+#else
+		const byte flags = Audio::FLAG_16BITS;
+#endif
+		Audio::SeekableAudioStream *stream = Audio::makeRawStream((byte *)samples, inFrames * sizeof(int16), 22050, flags);
+
+		Audio::SincFilter filter(22050, 48000, Audio::kRateQualityMedium);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 48000, false, false, &filter);
+
+		int16 out[1000 * 2];
+		int total = 0, n;
+		do {
+			memset(out, 0, sizeof(out));
+			n = converter->flow(*stream, out, 1000, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			// Skip the filter delay at the start
+			for (int i = (total == 0 ? 100 : 0); i < n; i++) {
+				TS_ASSERT_DELTA(out[i * 2], 10000, 4);
+				TS_ASSERT_DELTA(out[i * 2 + 1], 10000, 4);
+			}
+			total += n;
+		} while (n > 0);
+
+		TS_ASSERT_DELTA(total, 48000, filter.getTaps());
+
+		delete converter;
+		delete stream;
+	}
+
+	void test_saturate_bus() {
+		const int32 bus[10] = { 0, 1, -1, 32767, 32768, -32768, -32769, 100000, -100000, 1234 };
+		const int16 expected[10] = { 0, 1, -1, 32767, 32767, -32768, -32768, 32767, -32768, 1234 };
+		int16 out[10];
+		Audio::saturateBus(out, bus, 10);
+		TS_ASSERT_SAME_DATA(out, expected, sizeof(out));
+	}
+};
@@ -0,0 +1,104 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/dcl.h"
+#include "common/memstream.h"
+
+/**
+ * The packed data was made with a small PKWARE DCL encoder and checked
+ * against the original bit by bit decoder.
+ */
+static const byte dclAscii[] = {
+	0x01, 0x04, 0x2c, 0x8a, 0xa5, 0x7a, 0x4b, 0xf5, 0x8e, 0x57, 0x6c, 0x55,
+	0xc1, 0xf3, 0xf1, 0xbf, 0x07, 0x11, 0x90, 0x82, 0x34, 0xe2, 0x00, 0x28,
+	0x41, 0xb9, 0x17, 0xf0, 0x0f
+};
+
+// An overlapping run, a literal with a code longer than eight bits, and a
+// two byte copy
+static const char dclAsciiText[] = "This is a test. This is a test. Zzzzzzzzzzzzzzzzzzzzzzz\xe9!\xe9!";
+
+static const byte dclBinary[] = {
+	0x00, 0x06, 0x00, 0x1c, 0x70, 0x50, 0x81, 0xc3, 0x08, 0x15, 0x31, 0x70,
+	0xfc, 0x30, 0xd2, 0x84, 0xca, 0x16, 0x31, 0x69, 0xe0, 0xdc, 0xf1, 0x53,
+	0x88, 0xd1, 0x24, 0x4d, 0xa1, 0x50, 0xbd, 0xb2, 0xd5, 0x8b, 0xd8, 0x32,
+	0x69, 0xd9, 0xc0, 0x9d, 0x73, 0x57, 0x8f, 0xdf, 0x00, 0x05, 0x11, 0x01,
+	0x24, 0x0b, 0x41, 0x2e, 0x4e, 0xe9, 0x64, 0xc0, 0x3f
+};
+
+// Copies from before the beginning of the output
+static const byte dclInvalid[] = {
+	0x00, 0x04, 0x02, 0x08, 0xcc, 0x12, 0xf0, 0x0f
+};
+
+class DclTestSuite : public CxxTest::TestSuite {
+	// 40 literals, a 300 byte copy repeating the last three, a 100 byte copy
+	// from 340 bytes back, and a 9 byte copy from 37 bytes back
+	void makeBinaryText(byte *text) {
+		uint size = 0;
+		for (int i = 0; i < 40; i++)
+			text[size++] = i * 7;
+		const int copies[3][2] = { { 3, 300 }, { 340, 100 }, { 37, 9 } };
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < copies[i][1]; j++, size++)
+				text[size] = text[size - copies[i][0]];
+		TS_ASSERT_EQUALS(size, 449u);
+	}
+
+public:
+	void test_ascii() {
+		const uint32 size = sizeof(dclAsciiText) - 1;
+		byte unpacked[size];
+		Common::MemoryReadStream stream(dclAscii, sizeof(dclAscii));
+		TS_ASSERT(Common::decompressDCL(&stream, unpacked, sizeof(dclAscii), size));
+		TS_ASSERT_SAME_DATA(unpacked, dclAsciiText, size);
+	}
+
+	void test_binary() {
+		byte expected[449], unpacked[449];
+		makeBinaryText(expected);
+		Common::MemoryReadStream stream(dclBinary, sizeof(dclBinary));
+		TS_ASSERT(Common::decompressDCL(&stream, unpacked, sizeof(dclBinary), sizeof(unpacked)));
+		TS_ASSERT_SAME_DATA(unpacked, expected, sizeof(expected));
+	}
+
+	void test_stream() {
+		byte expected[449];
+		makeBinaryText(expected);
+		Common::MemoryReadStream stream(dclBinary, sizeof(dclBinary));
+		Common::SeekableReadStream *unpacked = Common::decompressDCL(&stream, sizeof(dclBinary), sizeof(expected));
+		TS_ASSERT(unpacked);
+		TS_ASSERT_EQUALS(unpacked->size(), (int64)sizeof(expected));
+		byte data[449];
+		unpacked->read(data, sizeof(data));
+		TS_ASSERT_SAME_DATA(data, expected, sizeof(expected));
+		delete unpacked;
+	}
+
+	void test_unknown_size() {
+		Common::MemoryReadStream stream(dclAscii, sizeof(dclAscii));
+		Common::SeekableReadStream *unpacked = Common::decompressDCL(&stream);
+		TS_ASSERT(unpacked);
+		TS_ASSERT_EQUALS(unpacked->size(), (int64)sizeof(dclAsciiText) - 1);
+		byte data[sizeof(dclAsciiText) - 1];
+		unpacked->read(data, sizeof(data));
+		TS_ASSERT_SAME_DATA(data, dclAsciiText, sizeof(data));
+		delete unpacked;
+	}
+
+	void test_errors() {
+		byte unpacked[449 + 1];
+
+		// The declared size is checked
+		Common::MemoryReadStream shortStream(dclBinary, sizeof(dclBinary));
+		TS_ASSERT(!Common::decompressDCL(&shortStream, unpacked, sizeof(dclBinary), 448));
+		Common::MemoryReadStream longStream(dclBinary, sizeof(dclBinary));
+		TS_ASSERT(!Common::decompressDCL(&longStream, unpacked, sizeof(dclBinary), 449 + 1));
+
+		Common::MemoryReadStream invalidStream(dclInvalid, sizeof(dclInvalid));
+		TS_ASSERT(!Common::decompressDCL(&invalidStream, unpacked, sizeof(dclInvalid), 6));
+
+		// Without an end marker, running out of data fails
+		Common::MemoryReadStream truncatedStream(dclAscii, sizeof(dclAscii) - 3);
+		TS_ASSERT(!Common::decompressDCL(&truncatedStream));
+	}
+};
@@ -0,0 +1,213 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flat-hashmap.h"
+#include "common/hash-str.h"
+#include "common/system.h"
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+		TS_ASSERT(!container.contains(0));
+
+		for (int i = 0; i < 100; i++)
+			container[i] = i;
+		container.clear(true);
+		TS_ASSERT(container.empty());
+		container[5] = 6;
+		TS_ASSERT_EQUALS(container[5], 6);
+
+		Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> container2;
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(container2.contains("FOO"));
+		container2.clear();
+		TS_ASSERT(container2.empty());
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		container[1] = 42;
+		TS_ASSERT(container.contains(1));
+		container.erase(0);
+		TS_ASSERT(!container.contains(0));
+		container.erase(4);
+		TS_ASSERT(!container.contains(4));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		TS_ASSERT(container.contains(2));
+		TS_ASSERT(container.contains(3));
+		TS_ASSERT_EQUALS(container.size(), 2u);
+		container.erase(2);
+		container.erase(3);
+		TS_ASSERT(container.empty());
+	}
+
+	void test_lookup() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+		container.setVal(2, 45);
+
+		TS_ASSERT_EQUALS(container[0], 17);
+		TS_ASSERT_EQUALS(container.getVal(1), -1);
+		TS_ASSERT_EQUALS(container.getValOrDefault(2), 45);
+		TS_ASSERT_EQUALS(container.getValOrDefault(3), 0);
+		TS_ASSERT_EQUALS(container.getValOrDefault(3, 7), 7);
+
+		int out = 0;
+		TS_ASSERT(container.tryGetVal(2, out));
+		TS_ASSERT_EQUALS(out, 45);
+		TS_ASSERT(!container.tryGetVal(3, out));
+
+		TS_ASSERT(container.find(1) != container.end());
+		TS_ASSERT_EQUALS(container.find(1)->_value, -1);
+		TS_ASSERT(container.find(5) == container.end());
+	}
+
+	void test_iterator_erase() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 200; i++)
+			container[i * 7] = i;
+
+		// Erasing the current entry does not disturb the iteration
+		int visited = 0;
+		for (Common::FlatHashMap<int, int>::iterator i = container.begin(); i != container.end(); ++i) {
+			visited++;
+			if (i->_value & 1)
+				container.erase(i);
+		}
+		TS_ASSERT_EQUALS(visited, 200);
+		TS_ASSERT_EQUALS(container.size(), 100u);
+
+		int sum = 0;
+		Common::FlatHashMap<int, int>::const_iterator j;
+		const Common::FlatHashMap<int, int> &constContainer = container;
+		for (j = constContainer.begin(); j != constContainer.end(); ++j) {
+			TS_ASSERT_EQUALS(j->_value & 1, 0);
+			TS_ASSERT_EQUALS(j->_key, j->_value * 7);
+			sum += j->_value;
+		}
+		TS_ASSERT_EQUALS(sum, 99 * 100);
+	}
+
+	void test_copy() {
+		Common::FlatHashMap<Common::String, int> map1, map2;
+		map1["one"] = 1;
+		map1["two"] = 2;
+		map1.erase("one");
+		map2 = map1;
+		map1["two"] = 3;
+		TS_ASSERT_EQUALS(map2.size(), 1u);
+		TS_ASSERT_EQUALS(map2["two"], 2);
+		TS_ASSERT(!map2.contains("one"));
+
+		Common::FlatHashMap<Common::String, int> map3(map1);
+		TS_ASSERT_EQUALS(map3["two"], 3);
+	}
+
+	// Random inserts, erases and lookups must match the pointer based map
+	void test_against_hashmap() {
+		_seed = 1;
+		Common::HashMap<uint32, uint32> reference;
+		Common::FlatHashMap<uint32, uint32> container;
+
+		for (int i = 0; i < 20000; i++) {
+			// A small key range makes erasing and reinserting likely
+			const uint32 key = nextRandom() % 2000;
+			switch (nextRandom() % 4) {
+			case 0:
+			case 1:
+				reference[key] = i;
+				container[key] = i;
+				break;
+			case 2:
+				reference.erase(key);
+				container.erase(key);
+				break;
+			default:
+				TS_ASSERT_EQUALS(container.contains(key), reference.contains(key));
+				TS_ASSERT_EQUALS(container.getValOrDefault(key, 0xFFFFFFFF), reference.getValOrDefault(key, 0xFFFFFFFF));
+				break;
+			}
+		}
+
+		TS_ASSERT_EQUALS(container.size(), reference.size());
+		for (Common::HashMap<uint32, uint32>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+			TS_ASSERT_EQUALS(container.getVal(i->_key), i->_value);
+		uint count = 0;
+		for (Common::FlatHashMap<uint32, uint32>::const_iterator i = container.begin(); i != container.end(); ++i, ++count)
+			TS_ASSERT_EQUALS(reference.getVal(i->_key), i->_value);
+		TS_ASSERT_EQUALS(count, reference.size());
+	}
+
+	/**
+	 * Compares the lookup speed of both maps with hash-like uint32 keys, as
+	 * used for resource and variable tables. Only the results are checked,
+	 * the timings are traced.
+	 */
+	void test_benchmark() {
+		const int kKeys = 20000;
+		const int kLookups = 1000000;
+
+		_seed = 2;
+		uint32 *keys = new uint32[kKeys];
+		for (int i = 0; i < kKeys; i++)
+			keys[i] = nextRandom() ^ (nextRandom() << 24);
+
+		Common::HashMap<uint32, uint32> hashMap;
+		Common::FlatHashMap<uint32, uint32> flatMap;
+
+		uint64 start = g_system->getMicros();
+		for (int i = 0; i < kKeys; i++)
+			hashMap[keys[i]] = i;
+		const uint64 hashMapInsert = g_system->getMicros() - start;
+
+		start = g_system->getMicros();
+		for (int i = 0; i < kKeys; i++)
+			flatMap[keys[i]] = i;
+		const uint64 flatMapInsert = g_system->getMicros() - start;
+
+		// Half of the lookups miss
+		uint32 hashMapSum = 0, flatMapSum = 0;
+		start = g_system->getMicros();
+		for (int i = 0; i < kLookups; i++)
+			hashMapSum += hashMap.getValOrDefault(keys[i % kKeys] + (i & 1), 1);
+		const uint64 hashMapLookup = g_system->getMicros() - start;
+
+		start = g_system->getMicros();
+		for (int i = 0; i < kLookups; i++)
+			flatMapSum += flatMap.getValOrDefault(keys[i % kKeys] + (i & 1), 1);
+		const uint64 flatMapLookup = g_system->getMicros() - start;
+
+		TS_ASSERT_EQUALS(hashMapSum, flatMapSum);
+		TS_TRACE(Common::String::format("%d inserts: HashMap %d us, FlatHashMap %d us", kKeys,
+			(int)hashMapInsert, (int)flatMapInsert).c_str());
+		TS_TRACE(Common::String::format("%d lookups: HashMap %d us, FlatHashMap %d us", kLookups,
+			(int)hashMapLookup, (int)flatMapLookup).c_str());
+
+		delete[] keys;
+	}
+};
@@ -104,4 +104,32 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_read_arrays() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		uint16 values16[4];
+		TS_ASSERT_EQUALS(ms.readUint16LEArray(values16, 2), 2u);
+		TS_ASSERT_EQUALS(values16[0], 0x0201);
+		TS_ASSERT_EQUALS(values16[1], 0x0403);
+		TS_ASSERT_EQUALS(ms.readUint16BEArray(values16, 1), 1u);
+		TS_ASSERT_EQUALS(values16[0], 0x0506);
+		TS_ASSERT_EQUALS(ms.pos(), 6);
+
+		// Only whole values are read
+		TS_ASSERT_EQUALS(ms.readUint16LEArray(values16, 3), 1u);
+		TS_ASSERT_EQUALS(values16[0], 0x0807);
+		TS_ASSERT(ms.eos());
+		TS_ASSERT_EQUALS(ms.pos(), 8);
+
+		uint32 values32[2];
+		ms.seek(0);
+		TS_ASSERT_EQUALS(ms.readUint32LEArray(values32, 1), 1u);
+		TS_ASSERT_EQUALS(values32[0], 0x04030201u);
+		TS_ASSERT_EQUALS(ms.readUint32BEArray(values32, 2), 1u);
+		TS_ASSERT_EQUALS(values32[0], 0x05060708u);
+		TS_ASSERT(ms.eos());
+		TS_ASSERT_EQUALS(ms.pos(), 8);
+	}
 };
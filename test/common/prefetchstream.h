@@ -0,0 +1,164 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/prefetchstream.h"
+
+#include "../test_random.h"
+
+/**
+ * A memory stream which counts the reads reaching it.
+ */
+class CountingReadStream : public Common::MemoryReadStream {
+public:
+	int _reads;
+
+	CountingReadStream(const byte *dataPtr, uint32 dataSize) : Common::MemoryReadStream(dataPtr, dataSize), _reads(0) { }
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		_reads++;
+		return Common::MemoryReadStream::read(dataPtr, dataSize);
+	}
+};
+
+class PrefetchingReadStreamTestSuite : public CxxTest::TestSuite {
+	byte _contents[1000];
+	TestRandom _random;
+
+public:
+	void setUp() {
+		for (int i = 0; i < 1000; i++)
+			_contents[i] = (byte)(i * 13 + (i >> 8));
+	}
+
+	void test_traverse() {
+		Common::MemoryReadStream ms(_contents, 10);
+		Common::PrefetchingReadStream stream(&ms, 4, 2, DisposeAfterUse::NO);
+
+		for (byte i = 0; i < 10; i++) {
+			TS_ASSERT(!stream.eos());
+			TS_ASSERT_EQUALS(stream.pos(), i);
+			TS_ASSERT_EQUALS(stream.readByte(), _contents[i]);
+		}
+
+		TS_ASSERT(!stream.eos());
+		byte b;
+		TS_ASSERT_EQUALS(stream.read(&b, 1), 0u);
+		TS_ASSERT(stream.eos());
+
+		TS_ASSERT(stream.seek(0));
+		TS_ASSERT(!stream.eos());
+		TS_ASSERT_EQUALS(stream.readByte(), _contents[0]);
+	}
+
+	void test_prefetch() {
+		CountingReadStream parent(_contents, 100);
+		Common::PrefetchingReadStream stream(&parent, 16, 4, DisposeAfterUse::NO);
+
+		// Three chunks can be read ahead of the one being read
+		TS_ASSERT_EQUALS(stream.prefetch(1), 1u);
+		TS_ASSERT_EQUALS(stream.prefetch(), 2u);
+		TS_ASSERT_EQUALS(stream.prefetch(), 0u);
+		TS_ASSERT_EQUALS(stream.bufferedSize(), 48u);
+		TS_ASSERT_EQUALS(parent._reads, 3);
+
+		byte data[100];
+		TS_ASSERT_EQUALS(stream.read(data, 40), 40u);
+		TS_ASSERT_SAME_DATA(data, _contents, 40);
+		TS_ASSERT_EQUALS(parent._reads, 3);
+		TS_ASSERT_EQUALS(stream.bufferedSize(), 8u);
+
+		// The chunks freed by the consumer are filled again
+		TS_ASSERT_EQUALS(stream.prefetch(), 3u);
+		TS_ASSERT_EQUALS(stream.bufferedSize(), 56u);
+		TS_ASSERT_EQUALS(stream.prefetch(), 0u);
+
+		// The rest is read when the consumer gets there
+		TS_ASSERT_EQUALS(stream.read(data + 40, 100), 60u);
+		TS_ASSERT_EQUALS(parent._reads, 7);
+		TS_ASSERT_SAME_DATA(data, _contents, 100);
+		TS_ASSERT(stream.eos());
+		TS_ASSERT_EQUALS(stream.pos(), 100);
+	}
+
+	void test_seek() {
+		CountingReadStream parent(_contents, 100);
+		Common::PrefetchingReadStream stream(&parent, 16, 4, DisposeAfterUse::NO);
+		stream.prefetch();
+
+		// Seeks within the prefetched chunks do not reach the parent
+		TS_ASSERT(stream.seek(20));
+		TS_ASSERT_EQUALS(stream.readByte(), _contents[20]);
+		TS_ASSERT(stream.seek(-5, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream.pos(), 16);
+		TS_ASSERT_EQUALS(stream.readByte(), _contents[16]);
+		TS_ASSERT(stream.seek(47));
+		TS_ASSERT_EQUALS(stream.readByte(), _contents[47]);
+		TS_ASSERT_EQUALS(parent._reads, 3);
+
+		// Chunks behind the current one are gone
+		TS_ASSERT(stream.seek(10));
+		TS_ASSERT_EQUALS(stream.readByte(), _contents[10]);
+		TS_ASSERT_EQUALS(parent._reads, 4);
+
+		TS_ASSERT(stream.seek(-1, SEEK_END));
+		TS_ASSERT_EQUALS(stream.readByte(), _contents[99]);
+		TS_ASSERT(!stream.eos());
+		stream.readByte();
+		TS_ASSERT(stream.eos());
+
+		TS_ASSERT(!stream.seek(101));
+		TS_ASSERT(!stream.seek(-1));
+		TS_ASSERT(stream.seek(0, SEEK_END));
+		TS_ASSERT_EQUALS(stream.pos(), 100);
+		TS_ASSERT(!stream.eos());
+	}
+
+	void test_parent_offset() {
+		Common::MemoryReadStream ms(_contents, 100);
+		ms.seek(30);
+		Common::PrefetchingReadStream stream(&ms, 8, 2, DisposeAfterUse::NO);
+		TS_ASSERT_EQUALS(stream.pos(), 30);
+		TS_ASSERT_EQUALS(stream.size(), 100);
+		TS_ASSERT_EQUALS(stream.readByte(), _contents[30]);
+	}
+
+	// Random reads, seeks and prefetches must match the plain stream
+	void test_against_memory_stream() {
+		_random.setSeed(1);
+		Common::MemoryReadStream reference(_contents, sizeof(_contents));
+		Common::MemoryReadStream parent(_contents, sizeof(_contents));
+		Common::PrefetchingReadStream stream(&parent, 37, 3, DisposeAfterUse::NO);
+
+		byte expected[200], data[200];
+		for (int i = 0; i < 2000; i++) {
+			switch (_random.next() % 4) {
+			case 0: {
+				const int64 offset = _random.next() % (sizeof(_contents) + 1);
+				TS_ASSERT(stream.seek(offset));
+				reference.seek(offset);
+				break;
+			}
+			case 1: {
+				const int64 offset = (int64)(_random.next() % 200) - 100;
+				if (reference.pos() + offset >= 0 && reference.pos() + offset <= reference.size()) {
+					TS_ASSERT(stream.seek(offset, SEEK_CUR));
+					reference.seek(offset, SEEK_CUR);
+				}
+				break;
+			}
+			case 2:
+				stream.prefetch(_random.next() % 3);
+				break;
+			default: {
+				const uint32 size = _random.next() % 200;
+				const uint32 n = reference.read(expected, size);
+				TS_ASSERT_EQUALS(stream.read(data, size), n);
+				TS_ASSERT_SAME_DATA(data, expected, n);
+				TS_ASSERT_EQUALS(stream.eos(), reference.eos());
+				break;
+			}
+			}
+			TS_ASSERT_EQUALS(stream.pos(), reference.pos());
+		}
+	}
+};
@@ -0,0 +1,153 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+
+/**
+ * An archive serving empty members, which counts how often it is asked.
+ * Unless indexed, it does not list its member paths.
+ */
+class CountingArchive : public Common::Archive {
+	Common::Array<Common::String> _names;
+	bool _indexed;
+
+public:
+	mutable int _probes;
+
+	CountingArchive(bool indexed) : _indexed(indexed), _probes(0) { }
+
+	void addName(const Common::String &name) { _names.push_back(name); }
+	void removeName(const Common::String &name) {
+		for (uint i = 0; i < _names.size(); i++)
+			if (_names[i] == name)
+				_names.remove_at(i--);
+	}
+
+	bool hasFile(const Common::Path &path) const override {
+		_probes++;
+		for (uint i = 0; i < _names.size(); i++)
+			if (_names[i].equalsIgnoreCase(path.rawString()))
+				return true;
+		return false;
+	}
+
+	int listMembers(Common::ArchiveMemberList &list) const override {
+		for (uint i = 0; i < _names.size(); i++)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(_names[i], this)));
+		return _names.size();
+	}
+
+	bool listMemberPaths(Common::Array<Common::String> &paths) const override {
+		if (!_indexed)
+			return false;
+		for (uint i = 0; i < _names.size(); i++)
+			paths.push_back(_names[i]);
+		return true;
+	}
+
+	const Common::ArchiveMemberPtr getMember(const Common::Path &path) const override {
+		if (!hasFile(path))
+			return Common::ArchiveMemberPtr();
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(path.rawString(), this));
+	}
+
+	Common::SeekableReadStream *createReadStreamForMember(const Common::Path &path) const override {
+		if (!hasFile(path))
+			return nullptr;
+		// The size tells which archive served the member
+		byte *data = (byte *)calloc(_names.size(), 1);
+		return new Common::MemoryReadStream(data, _names.size(), DisposeAfterUse::YES);
+	}
+};
+
+class SearchSetTestSuite : public CxxTest::TestSuite {
+public:
+	void test_indexed_lookup() {
+		Common::SearchSet set;
+		CountingArchive *first = new CountingArchive(true);
+		CountingArchive *second = new CountingArchive(true);
+		first->addName("one.dat");
+		second->addName("one.dat");
+		second->addName("Two.dat");
+		set.add("first", first, 1);
+		set.add("second", second, 0);
+
+		TS_ASSERT(set.hasFile("ONE.DAT"));
+		TS_ASSERT(set.hasFile("two.dat"));
+		TS_ASSERT(!set.hasFile("three.dat"));
+		// Hits are confirmed by the indexed archive only, misses ask nobody
+		TS_ASSERT_EQUALS(first->_probes, 1);
+		TS_ASSERT_EQUALS(second->_probes, 1);
+
+		// The archive with the higher priority serves shared names
+		Common::SeekableReadStream *stream = set.createReadStreamForMember("one.dat");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 1);
+		delete stream;
+		TS_ASSERT(!set.createReadStreamForMember("three.dat"));
+
+		// Reordering the archives rebuilds the index
+		set.setPriority("first", -1);
+		stream = set.createReadStreamForMember("one.dat");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 2);
+		delete stream;
+
+		// A member gone from the indexed archive is looked up in the others
+		first->removeName("one.dat");
+		TS_ASSERT(set.hasFile("one.dat"));
+		second->removeName("Two.dat");
+		TS_ASSERT(!set.hasFile("two.dat"));
+
+		set.remove("second");
+		TS_ASSERT(!set.hasFile("one.dat"));
+		first->addName("one.dat");
+		set.invalidateIndex();
+		TS_ASSERT(set.hasFile("one.dat"));
+		TS_ASSERT(!set.hasFile("two.dat"));
+
+		// Members added to an archive need an explicit invalidation
+		first->addName("three.dat");
+		TS_ASSERT(!set.hasFile("three.dat"));
+		set.invalidateIndex();
+		TS_ASSERT(set.hasFile("three.dat"));
+	}
+
+	void test_unindexed_archives() {
+		Common::SearchSet set;
+		CountingArchive *indexed = new CountingArchive(true);
+		CountingArchive *unindexed = new CountingArchive(false);
+		CountingArchive *last = new CountingArchive(false);
+		indexed->addName("a.dat");
+		indexed->addName("b.dat");
+		unindexed->addName("b.dat");
+		unindexed->addName("c.dat");
+		unindexed->addName("d.dat");
+		last->addName("a.dat");
+		set.add("indexed", indexed, 0);
+		set.add("unindexed", unindexed, 1);
+		set.add("last", last, -1);
+
+		TS_ASSERT(set.hasFile("a.dat"));
+		TS_ASSERT(set.hasFile("c.dat"));
+		TS_ASSERT(!set.hasFile("e.dat"));
+
+		// Archives without an index which come first are still asked
+		Common::SeekableReadStream *stream = set.createReadStreamForMember("b.dat");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 3);
+		delete stream;
+
+		// But not those behind the archive found in the index
+		last->_probes = 0;
+		stream = set.createReadStreamForMember("a.dat");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 2);
+		delete stream;
+		TS_ASSERT_EQUALS(last->_probes, 0);
+
+		Common::ArchiveMemberPtr member = set.getMember("c.dat");
+		TS_ASSERT(member);
+		TS_ASSERT(!set.getMember("e.dat"));
+	}
+};
@@ -805,4 +805,29 @@ public:
 			}
 		}
 	}
+
+	void test_read_span() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		ms.readByte();
+		Common::Span<const byte> span = Common::readSpan(ms, 4);
+		TS_ASSERT_EQUALS(span.size(), 4u);
+		// A view of the buffer, not a copy
+		TS_ASSERT_EQUALS(span.data(), contents + 1);
+		TS_ASSERT_EQUALS(span.getUint16BEAt(0), 0x0203);
+		TS_ASSERT_EQUALS(span.getUint16LEAt(2), 0x0504);
+		TS_ASSERT_EQUALS(ms.pos(), 5);
+
+		// Too short, nothing is read
+		span = Common::readSpan(ms, 3);
+		TS_ASSERT(!span);
+		TS_ASSERT(ms.eos());
+		TS_ASSERT_EQUALS(ms.pos(), 5);
+
+		ms.seek(5);
+		span = Common::readSpan(ms, 2);
+		TS_ASSERT_EQUALS(span[1], 7);
+		TS_ASSERT(!ms.eos());
+	}
 };
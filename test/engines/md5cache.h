@@ -0,0 +1,111 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "engines/md5cache.h"
+
+class PersistentMD5CacheTestSuite : public CxxTest::TestSuite {
+	static Common::MemoryReadStream *makeStream(const char *contents) {
+		return new Common::MemoryReadStream((const byte *)contents, strlen(contents));
+	}
+
+public:
+	void test_parse() {
+		Common::MemoryReadStream *stream = makeStream(
+			"# ScummVM MD5 cache 2\n"
+			"0123456789abcdef0123456789abcdef\t1234\t1600000000123456789\tf:5000:/games/a/data.000\n"
+			"fedcba9876543210fedcba9876543210\t-1\t0\tt:5000:/games/b/with\ttab\n");
+		PersistentMD5Cache cache;
+		TS_ASSERT(cache.load(*stream));
+		delete stream;
+		TS_ASSERT_EQUALS(cache.size(), 2u);
+		TS_ASSERT(!cache.isDirty());
+
+		Common::String md5;
+		TS_ASSERT(cache.get("f:5000:/games/a/data.000", 1234, 1600000000123456789LL, md5));
+		TS_ASSERT_EQUALS(md5, "0123456789abcdef0123456789abcdef");
+		// The key is the rest of the line
+		TS_ASSERT(cache.get("t:5000:/games/b/with\ttab", -1, 0, md5));
+		TS_ASSERT_EQUALS(md5, "fedcba9876543210fedcba9876543210");
+
+		// Entries only hold while size and time are the same
+		TS_ASSERT(!cache.get("f:5000:/games/a/data.000", 1235, 1600000000123456789LL, md5));
+		TS_ASSERT(!cache.get("f:5000:/games/a/data.000", 1234, 1600000000123456788LL, md5));
+		TS_ASSERT(!cache.get("f:5000:/games/a/DATA.000", 1234, 1600000000123456789LL, md5));
+	}
+
+	void test_malformed() {
+		Common::MemoryReadStream *stream = makeStream(
+			"# ScummVM MD5 cache 2\n"
+			"0123456789abcdef0123456789abcdef\t1234\n"
+			"0123456789abcdef0123456789abcdef\t12a4\t5\tf:5000:/a\n"
+			"0123456789abcdef0123456789abcdef\t1234\t-\tf:5000:/b\n"
+			"0123456789abcdef0123456789abcdef\t1234\t5\t\n"
+			"\n"
+			"0123456789abcdef0123456789abcdef\t1234\t5\tf:5000:/c");
+		PersistentMD5Cache cache;
+		TS_ASSERT(cache.load(*stream));
+		delete stream;
+
+		// Only the last line, without a line break, is whole
+		TS_ASSERT_EQUALS(cache.size(), 1u);
+		Common::String md5;
+		TS_ASSERT(cache.get("f:5000:/c", 1234, 5, md5));
+
+		// Other versions are not read at all
+		stream = makeStream(
+			"# ScummVM MD5 cache 1\n"
+			"0123456789abcdef0123456789abcdef\t1234\t5\tf:5000:/d\n");
+		TS_ASSERT(!cache.load(*stream));
+		delete stream;
+		TS_ASSERT(!cache.get("f:5000:/d", 1234, 5, md5));
+	}
+
+	void test_round_trip() {
+		PersistentMD5Cache cache;
+		cache.set("f:5000:/games/a/data.000", 1234, 1600000000123456789LL, "0123456789abcdef0123456789abcdef");
+		cache.set("t:0:/games/b/file", 0, -5, "fedcba9876543210fedcba9876543210");
+		// Would break the line based file
+		cache.set("f:5000:/games/c\nfile", 1, 1, "fedcba9876543210fedcba9876543210");
+		TS_ASSERT(cache.isDirty());
+		TS_ASSERT_EQUALS(cache.size(), 2u);
+
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		cache.save(out);
+
+		Common::MemoryReadStream in(out.getData(), out.size());
+		PersistentMD5Cache loaded;
+		TS_ASSERT(loaded.load(in));
+		TS_ASSERT_EQUALS(loaded.size(), 2u);
+
+		Common::String md5;
+		TS_ASSERT(loaded.get("f:5000:/games/a/data.000", 1234, 1600000000123456789LL, md5));
+		TS_ASSERT_EQUALS(md5, "0123456789abcdef0123456789abcdef");
+		TS_ASSERT(loaded.get("t:0:/games/b/file", 0, -5, md5));
+		TS_ASSERT_EQUALS(md5, "fedcba9876543210fedcba9876543210");
+	}
+
+	void test_prune() {
+		// Beyond kMaxEntries, entries not used in the session are dropped
+		Common::MemoryWriteStreamDynamic file(DisposeAfterUse::YES);
+		file.writeString("# ScummVM MD5 cache 2\n");
+		for (uint i = 0; i <= PersistentMD5Cache::kMaxEntries; i++)
+			file.writeString(Common::String::format("0123456789abcdef0123456789abcdef\t1\t1\tf:0:/%d\n", i));
+
+		PersistentMD5Cache cache;
+		Common::MemoryReadStream in(file.getData(), file.size());
+		TS_ASSERT(cache.load(in));
+		TS_ASSERT_EQUALS(cache.size(), PersistentMD5Cache::kMaxEntries + 1);
+		Common::String md5;
+		TS_ASSERT(cache.get("f:0:/7", 1, 1, md5));
+		cache.set("f:0:/new", 2, 2, "fedcba9876543210fedcba9876543210");
+
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		cache.save(out);
+		Common::MemoryReadStream saved(out.getData(), out.size());
+		PersistentMD5Cache loaded;
+		TS_ASSERT(loaded.load(saved));
+		TS_ASSERT_EQUALS(loaded.size(), 2u);
+		TS_ASSERT(loaded.get("f:0:/7", 1, 1, md5));
+		TS_ASSERT(loaded.get("f:0:/new", 2, 2, md5));
+	}
+};
@@ -0,0 +1,78 @@
+#include <cxxtest/TestSuite.h>
+#include "../../test_random.h"
+#include "engines/neverhood/blend.h"
+
+/**
+ * Test suite for the shadow span blending in engines/neverhood/blend.h.
+ * Random spans, with alpha biased towards 0 and 255, are blended with and
+ * without an RGB offset, SIMD and scalar results must match bit for bit.
+ */
+
+class NeverhoodBlendTestSuite : public CxxTest::TestSuite {
+	TestRandom _random;
+
+	// Alpha values are biased towards the special cases of blendColor()
+	byte nextAlpha() {
+		switch (_random.nextByte() % 4) {
+		case 0:
+			return 0;
+		case 1:
+			return 255;
+		default:
+			return _random.nextByte();
+		}
+	}
+
+	void fillPixels(byte *pixels, int width) {
+		for (int i = 0; i < width * 4; i += 4) {
+			pixels[i + 0] = _random.nextByte();
+			pixels[i + 1] = _random.nextByte();
+			pixels[i + 2] = _random.nextByte();
+			pixels[i + 3] = nextAlpha();
+		}
+	}
+
+	void compareSpans(const Graphics::RgbOffset *rgbOffset) {
+		byte mask[37 * 4], shadow[37 * 4], dst[37 * 4], expected[37 * 4];
+		for (int width = 1; width <= 37; width++) {
+			for (int run = 0; run < 8; run++) {
+				fillPixels(mask, width);
+				fillPixels(shadow, width);
+				fillPixels(dst, width);
+				// Fully transparent mask groups take the skip path
+				if (run == 0)
+					for (int i = 3; i < width * 4; i += 4)
+						mask[i] = 0;
+				memcpy(expected, dst, width * 4);
+				Neverhood::blendShadowSpanScalar(expected, mask, shadow, width, rgbOffset);
+				Neverhood::blendShadowSpan(dst, mask, shadow, width, rgbOffset);
+				TS_ASSERT_SAME_DATA(dst, expected, width * 4);
+			}
+		}
+	}
+
+public:
+	void test_shadow_span() {
+		_random.setSeed(1);
+		compareSpans(nullptr);
+	}
+
+	void test_shadow_span_rgb_offset() {
+		_random.setSeed(2);
+		Graphics::RgbOffset rgbOffset;
+		const int16 offset[3] = { -300, 40, 255 };
+		rgbOffset.init(offset);
+		compareSpans(&rgbOffset);
+	}
+
+	void test_shadow_span_fade() {
+		_random.setSeed(3);
+		Graphics::RgbOffset rgbOffset;
+		rgbOffset.init_fade_from_black();
+		rgbOffset.cur_rgb[0] = 40;
+		rgbOffset.cur_rgb[1] = 128;
+		rgbOffset.cur_rgb[2] = 200;
+		rgbOffset.updateOffset();
+		compareSpans(&rgbOffset);
+	}
+};
@@ -0,0 +1,72 @@
+#include <cxxtest/TestSuite.h>
+#include "../../test_random.h"
+#include "engines/neverhood/delta.h"
+
+/**
+ * Test suite for the sound delta decoder in engines/neverhood/delta.h.
+ * Checks the running sum across odd sized pieces and its 16-bit wrap
+ * around for every shift value.
+ */
+
+class NeverhoodDeltaTestSuite : public CxxTest::TestSuite {
+	TestRandom _random;
+
+	// Decodes the deltas in pieces of the given sizes with both paths
+	void checkPieces(const byte *src, const int *sizes, int count, byte shiftValue) {
+		int16 expected[256], samples[256];
+		int16 expectedPrev = 0, prev = 0;
+		int offset = 0;
+		for (int i = 0; i < count; i++) {
+			Neverhood::decodeDeltaSamplesScalar(src + offset, expected + offset, sizes[i], expectedPrev, shiftValue);
+			Neverhood::decodeDeltaSamples(src + offset, samples + offset, sizes[i], prev, shiftValue);
+			TS_ASSERT_EQUALS(prev, expectedPrev);
+			offset += sizes[i];
+		}
+		TS_ASSERT_SAME_DATA(samples, expected, offset * sizeof(int16));
+	}
+
+public:
+	void test_scalar() {
+		const byte deltas[4] = { 1, 2, 0xFF, 0x80 };
+		int16 samples[4];
+		int16 prev = 10;
+		Neverhood::decodeDeltaSamplesScalar(deltas, samples, 4, prev, 1);
+		TS_ASSERT_EQUALS(samples[0], 22);
+		TS_ASSERT_EQUALS(samples[1], 26);
+		TS_ASSERT_EQUALS(samples[2], 24);
+		TS_ASSERT_EQUALS(samples[3], -232);
+		TS_ASSERT_EQUALS(prev, -116);
+	}
+
+	void test_tails() {
+		// Pieces which are no multiple of 8 leave tails for the scalar path,
+		// the running sum has to carry over between them
+		const int sizes[] = { 0, 1, 7, 8, 9, 15, 16, 17, 31, 33, 64, 50 };
+		_random.setSeed(1);
+		byte src[256];
+		for (int i = 0; i < 256; i++)
+			src[i] = _random.nextByte();
+		for (byte shiftValue = 0; shiftValue < 16; shiftValue++)
+			checkPieces(src, sizes, ARRAYSIZE(sizes), shiftValue);
+	}
+
+	void test_wrap_around() {
+		// Runs of the largest deltas overflow the running sum and the shift,
+		// which wrap around in 16 bits instead of saturating
+		const int sizes[] = { 3, 253 };
+		byte src[256];
+		for (int run = 0; run < 3; run++) {
+			for (int i = 0; i < 256; i++)
+				src[i] = run == 0 ? 0x7F : (run == 1 ? 0x80 : (i & 16 ? 0x7F : 0x80));
+			for (byte shiftValue = 0; shiftValue < 16; shiftValue++)
+				checkPieces(src, sizes, ARRAYSIZE(sizes), shiftValue);
+		}
+
+		int16 samples[8];
+		int16 prev = 0x7FF0;
+		memset(src, 0x7F, 8);
+		Neverhood::decodeDeltaSamples(src, samples, 8, prev, 0);
+		TS_ASSERT_EQUALS(samples[0], (int16)0x806F);
+		TS_ASSERT_EQUALS(prev, (int16)(0x7FF0 + 8 * 0x7F));
+	}
+};
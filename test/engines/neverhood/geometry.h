@@ -0,0 +1,58 @@
+#include <cxxtest/TestSuite.h>
+#include "engines/neverhood/geometry.h"
+#include "engines/neverhood/scale.h"
+
+/**
+ * Test suite for the 32-bit geometry in engines/neverhood/geometry.h
+ * at the scale factors of 8K (7680 pixels wide) and 12K (11520 pixels wide)
+ * asset packs.
+ */
+
+class NeverhoodGeometryTestSuite : public CxxTest::TestSuite {
+	public:
+	void test_scale_8k() {
+		Neverhood::ScaleTransform scale(12, 1);
+		TS_ASSERT_EQUALS(scale.up(640), 7680);
+		TS_ASSERT_EQUALS(scale.up(480), 5760);
+		TS_ASSERT_EQUALS(scale.down(7679), 639);
+		TS_ASSERT_EQUALS(Neverhood::calcPitch(scale.up(640), 4), 30720u);
+		TS_ASSERT(Neverhood::calcPitch(scale.up(640), 4) <= Neverhood::kMaxSurfacePitch);
+	}
+
+	void test_scale_12k() {
+		Neverhood::ScaleTransform scale(18, 1);
+		const Neverhood::NCoord width = scale.up(640);
+		const Neverhood::NCoord height = scale.up(480);
+		TS_ASSERT_EQUALS(width, 11520);
+		TS_ASSERT_EQUALS(height, 8640);
+		TS_ASSERT_EQUALS(scale.down(width), 640);
+
+		// Does not fit a Graphics::Surface, but must not wrap around either
+		const Neverhood::NPitch pitch = Neverhood::calcPitch(width, 4);
+		TS_ASSERT_EQUALS(pitch, 46080u);
+		TS_ASSERT(pitch > Neverhood::kMaxSurfacePitch);
+		TS_ASSERT_EQUALS(Neverhood::calcPixelOffset(width - 1, height - 1, pitch, 4), 46080u * 8640u - 4u);
+	}
+
+	void test_rect_12k() {
+		Neverhood::ScaleTransform scale(18, 1);
+		Neverhood::NRect r = Neverhood::NRect::make(scale.up(-10), scale.up(100), scale.up(700), scale.up(500));
+		TS_ASSERT_EQUALS(r.width(), 12780);
+		r.clip(Neverhood::NRect::make(0, 0, scale.up(640) - 1, scale.up(480) - 1));
+		TS_ASSERT_EQUALS(r.x1, 0);
+		TS_ASSERT_EQUALS(r.y1, 1800);
+		TS_ASSERT_EQUALS(r.x2, 11519);
+		TS_ASSERT_EQUALS(r.y2, 8639);
+		TS_ASSERT(r.contains(scale.up(639), scale.up(479)));
+
+		Neverhood::NDrawRect drawRect(scale.up(600), scale.up(400), scale.up(40), scale.up(80));
+		TS_ASSERT_EQUALS(drawRect.x2(), 11520);
+		TS_ASSERT_EQUALS(drawRect.y2(), 8640);
+	}
+
+	void test_invalid_pitch() {
+		TS_ASSERT_EQUALS(Neverhood::calcPitch(0, 4), 0u);
+		TS_ASSERT_EQUALS(Neverhood::calcPitch(-5, 4), 0u);
+		TS_ASSERT_EQUALS(Neverhood::calcPitch(0x40000000, 4), 0u);
+	}
+};
@@ -0,0 +1,51 @@
+#include <cxxtest/TestSuite.h>
+#include "engines/neverhood/scale.h"
+
+/**
+ * Test suite for the coordinate scaling in engines/neverhood/scale.h
+ *
+ * Every preset must match the plain integer expression the engine used
+ * before, for the whole int16 range.
+ */
+
+class NeverhoodScaleTestSuite : public CxxTest::TestSuite {
+	static bool matchesReference(int16 dividend, int16 divisor) {
+		Neverhood::ScaleTransform scale(dividend, divisor);
+		for (int i = -32768; i <= 32767; i++) {
+			if (scale.up(i) != i * dividend / divisor)
+				return false;
+			if (scale.down(i) != i * divisor / dividend)
+				return false;
+		}
+		return true;
+	}
+
+	public:
+	void test_default_preset() {
+		Neverhood::ScaleTransform scale;
+		TS_ASSERT_EQUALS(scale.getPreset(), Neverhood::ScaleTransform::kPreset9x2);
+		TS_ASSERT_EQUALS(scale.up(640), 2880);
+		TS_ASSERT_EQUALS(scale.up(-15), -67);
+		TS_ASSERT_EQUALS(scale.down(2880), 640);
+		TS_ASSERT_EQUALS(scale.down(-67), -14);
+	}
+
+	void test_preset_selection() {
+		TS_ASSERT_EQUALS(Neverhood::ScaleTransform(1, 1).getPreset(), Neverhood::ScaleTransform::kPreset1x);
+		TS_ASSERT_EQUALS(Neverhood::ScaleTransform(4, 2).getPreset(), Neverhood::ScaleTransform::kPreset2x);
+		TS_ASSERT_EQUALS(Neverhood::ScaleTransform(18, 4).getPreset(), Neverhood::ScaleTransform::kPreset9x2);
+		TS_ASSERT_EQUALS(Neverhood::ScaleTransform(5, 2).getPreset(), Neverhood::ScaleTransform::kPresetGeneric);
+		TS_ASSERT_EQUALS(Neverhood::ScaleTransform(0, 2).getPreset(), Neverhood::ScaleTransform::kPreset1x);
+	}
+
+	void test_presets_match_reference() {
+		TS_ASSERT(matchesReference(1, 1));
+		TS_ASSERT(matchesReference(2, 1));
+		TS_ASSERT(matchesReference(3, 1));
+		TS_ASSERT(matchesReference(4, 1));
+		TS_ASSERT(matchesReference(9, 2));
+		TS_ASSERT(matchesReference(18, 4));
+		TS_ASSERT(matchesReference(5, 2));
+		TS_ASSERT(matchesReference(27, 8));
+	}
+};
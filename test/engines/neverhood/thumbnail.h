@@ -0,0 +1,64 @@
+#include <cxxtest/TestSuite.h>
+#include "../../test_random.h"
+#include "engines/neverhood/thumbnail.h"
+
+/**
+ * Test suite for the thumbnail box filter in engines/neverhood/thumbnail.h.
+ * Covers the channel order of both pixel formats and column widths which
+ * overflow a single 16-bit accumulator block.
+ */
+
+class NeverhoodThumbnailTestSuite : public CxxTest::TestSuite {
+	TestRandom _random;
+
+public:
+	void test_scalar_channels() {
+		// One pixel per column, in two formats with a different byte order
+		const Graphics::PixelFormat rgba(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		const Graphics::PixelFormat bgra(4, 8, 8, 8, 8, 8, 16, 24, 0);
+		const uint32 pixels[2] = { rgba.ARGBToColor(255, 10, 20, 30), bgra.ARGBToColor(255, 10, 20, 30) };
+		const int columns[2] = { 0, 1 };
+
+		uint32 sums[3] = { 0, 0, 0 };
+		Neverhood::sumThumbnailRowScalar((const byte *)&pixels[0], columns, 1, rgba, sums);
+		TS_ASSERT_EQUALS(sums[0], 10u);
+		TS_ASSERT_EQUALS(sums[1], 20u);
+		TS_ASSERT_EQUALS(sums[2], 30u);
+
+		Neverhood::sumThumbnailRowScalar((const byte *)&pixels[1], columns, 1, bgra, sums);
+		TS_ASSERT_EQUALS(sums[0], 20u);
+		TS_ASSERT_EQUALS(sums[1], 40u);
+		TS_ASSERT_EQUALS(sums[2], 60u);
+	}
+
+	void test_row_sums() {
+		// Column widths cover the 4 pixel steps, their tails and more than
+		// one 16-bit accumulator block
+		const int kWidth = 3000;
+		const int widths[] = { 0, 1, 3, 4, 7, 8, 13, 24, 1024, 1029, 887 };
+		const int count = ARRAYSIZE(widths);
+		int columns[count + 1];
+		columns[0] = 0;
+		for (int i = 0; i < count; i++)
+			columns[i + 1] = columns[i] + widths[i];
+		TS_ASSERT_EQUALS(columns[count], kWidth);
+
+		static byte source[kWidth * 4];
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 0, 8, 16, 24);
+
+		for (int run = 0; run < 3; run++) {
+			_random.setSeed(run + 1);
+			for (int i = 0; i < kWidth * 4; i++)
+				source[i] = run == 0 ? 255 : _random.nextByte();
+
+			uint32 expected[count * 3], sums[count * 3];
+			memset(expected, 0, sizeof(expected));
+			memset(sums, 0, sizeof(sums));
+			Neverhood::sumThumbnailRowScalar(source, columns, count, format, expected);
+			Neverhood::sumThumbnailRow(source, columns, count, format, sums);
+			TS_ASSERT_SAME_DATA(sums, expected, sizeof(sums));
+			if (run == 0)
+				TS_ASSERT_EQUALS(expected[8 * 3], 1024u * 255);
+		}
+	}
+};
@@ -0,0 +1,73 @@
+#include <cxxtest/TestSuite.h>
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/memstream.h"
+#include "image/png.h"
+#include "graphics/surface.h"
+
+class PNGDecoderTestSuite : public CxxTest::TestSuite {
+	// 2x2 RGBA: red, green (alpha 128), blue, white (alpha 0)
+	static const uint8 *pngBuf() {
+		static const uint8 buf[78] = {
+			0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+			0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x08, 0x06, 0x00, 0x00, 0x00, 0x72, 0xb6, 0x0d,
+			0x24, 0x00, 0x00, 0x00, 0x15, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0xf8, 0xcf, 0xc0, 0xf0,
+			0x1f, 0x08, 0x1b, 0x18, 0x80, 0x34, 0x08, 0x30, 0x00, 0x00, 0x43, 0xd3, 0x08, 0x79, 0x78, 0xce,
+			0x21, 0xcc, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82
+		};
+		return buf;
+	}
+
+	class TestBuffer : public Image::PNGDecoder::OutputBuffer {
+	public:
+		byte _data[256];
+		uint32 _pitch;
+
+		byte *allocate(uint16 width, uint16 height, uint32 pitch) override {
+			_pitch = pitch;
+			return pitch * height <= sizeof(_data) ? _data : nullptr;
+		}
+	};
+
+public:
+	void test_load_into_rgba() {
+#ifdef USE_PNG
+		Image::PNGDecoder decoder;
+		Common::MemoryReadStream stream(pngBuf(), 78);
+		TestBuffer buffer;
+		Graphics::Surface surface;
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+		TS_ASSERT(decoder.loadStreamInto(stream, surface, format, 16, buffer));
+		TS_ASSERT_EQUALS(buffer._pitch, 16u);
+		TS_ASSERT_EQUALS(surface.w, 2);
+		TS_ASSERT_EQUALS(surface.h, 2);
+		TS_ASSERT_EQUALS(surface.pitch, 16);
+		TS_ASSERT_EQUALS(surface.getPixels(), (void *)buffer._data);
+		TS_ASSERT_EQUALS(decoder.getSurface(), (const Graphics::Surface *)nullptr);
+
+		TS_ASSERT_EQUALS(*(const uint32 *)surface.getBasePtr(0, 0), format.ARGBToColor(255, 255, 0, 0));
+		TS_ASSERT_EQUALS(*(const uint32 *)surface.getBasePtr(1, 0), format.ARGBToColor(128, 0, 255, 0));
+		TS_ASSERT_EQUALS(*(const uint32 *)surface.getBasePtr(0, 1), format.ARGBToColor(255, 0, 0, 255));
+		TS_ASSERT_EQUALS(*(const uint32 *)surface.getBasePtr(1, 1), format.ARGBToColor(0, 255, 255, 255));
+#endif
+	}
+
+	void test_load_into_rgb565() {
+#ifdef USE_PNG
+		Image::PNGDecoder decoder;
+		Common::MemoryReadStream stream(pngBuf(), 78);
+		TestBuffer buffer;
+		Graphics::Surface surface;
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+
+		TS_ASSERT(decoder.loadStreamInto(stream, surface, format, 8, buffer));
+		TS_ASSERT_EQUALS(surface.pitch, 8);
+		TS_ASSERT_EQUALS(*(const uint16 *)surface.getBasePtr(0, 0), format.RGBToColor(255, 0, 0));
+		TS_ASSERT_EQUALS(*(const uint16 *)surface.getBasePtr(0, 1), format.RGBToColor(0, 0, 255));
+#endif
+	}
+};
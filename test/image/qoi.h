@@ -0,0 +1,51 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "image/qoi.h"
+#include "graphics/surface.h"
+
+class QOIDecoderTestSuite : public CxxTest::TestSuite {
+public:
+	void test_load_qoi_2x2() {
+		// red, red (run), blue, red (index)
+		const uint8 qoiBuf[] = {
+			'q', 'o', 'i', 'f', 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x04, 0x00,
+			0xff, 0xff, 0x00, 0x00, 0xff,
+			0xc0,
+			0xfe, 0x00, 0x00, 0xff,
+			0x32,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01
+		};
+
+		Image::QOIDecoder decoder;
+		Common::MemoryReadStream stream(qoiBuf, sizeof(qoiBuf));
+		const bool status = decoder.loadStream(stream);
+		TS_ASSERT(status);
+		if (!status) {
+			return;
+		}
+		const Graphics::Surface *surface = decoder.getSurface();
+		TS_ASSERT_EQUALS(surface->w, 2);
+		TS_ASSERT_EQUALS(surface->h, 2);
+		TS_ASSERT_EQUALS(surface->format.bytesPerPixel, 4);
+
+		const uint8 red[4] = { 0xff, 0x00, 0x00, 0xff };
+		const uint8 blue[4] = { 0x00, 0x00, 0xff, 0xff };
+		TS_ASSERT_SAME_DATA(surface->getBasePtr(0, 0), red, 4);
+		TS_ASSERT_SAME_DATA(surface->getBasePtr(1, 0), red, 4);
+		TS_ASSERT_SAME_DATA(surface->getBasePtr(0, 1), blue, 4);
+		TS_ASSERT_SAME_DATA(surface->getBasePtr(1, 1), red, 4);
+	}
+
+	void test_reject_truncated_qoi() {
+		const uint8 qoiBuf[] = {
+			'q', 'o', 'i', 'f', 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x04, 0x00,
+			0xff, 0xff, 0x00, 0x00, 0xff,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01
+		};
+
+		Image::QOIDecoder decoder;
+		Common::MemoryReadStream stream(qoiBuf, sizeof(qoiBuf));
+		TS_ASSERT(!decoder.loadStream(stream));
+	}
+};
@@ -5,7 +5,7 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h $(srcdir)/test/image/*.h
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h $(srcdir)/test/image/*.h $(srcdir)/test/engines/*.h
 TEST_LIBS    :=
 
 ifdef POSIX
@@ -28,13 +28,17 @@ TEST_LIBS += test/null_osystem.o \
 	backends/platform/sdl/win32/win32_wrapper.o
 endif
 
-TEST_LIBS +=	audio/libaudio.a math/libmath.a common/libcommon.a image/libimage.a graphics/libgraphics.a
+TEST_LIBS +=	engines/md5cache.o audio/libaudio.a math/libmath.a common/libcommon.a image/libimage.a graphics/libgraphics.a
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
 	TEST_LIBS += engines/wintermute/libwintermute.a
 endif
 
+ifdef ENABLE_NEVERHOOD
+	TESTS += $(srcdir)/test/engines/neverhood/*.h
+endif
+
 ifeq ($(ENABLE_ULTIMA), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/ultima/*/*/*.h
 	TEST_LIBS += engines/ultima/libultima.a
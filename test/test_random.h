@@ -0,0 +1,28 @@
+#ifndef TEST_TEST_RANDOM_H
+#define TEST_TEST_RANDOM_H
+
+#include "common/scummsys.h"
+
+/**
+ * Seeded pseudo random numbers for the suites which feed two code paths the
+ * same input. Unlike Common::RandomSource this needs no OSystem, and a seed
+ * always gives the same sequence.
+ */
+class TestRandom {
+public:
+	TestRandom(uint32 seed = 1) : _seed(seed) {}
+
+	void setSeed(uint32 seed) { _seed = seed; }
+
+	uint32 next() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	byte nextByte() { return (byte)(next() >> 8); }
+
+private:
+	uint32 _seed;
+};
+
+#endif
@@ -222,6 +222,27 @@ void TheoraDecoder::close() {
 	_hasVideo = _hasAudio = false;
 }
 
+uint32 TheoraDecoder::getNextFrameStartTime() const {
+	return _videoTrack ? _videoTrack->getNextFrameStartTime() : 0;
+}
+
+bool TheoraDecoder::isNextFrameLate() const {
+	if (!_videoTrack || !isPlaying() || isPaused() || endOfVideo())
+		return false;
+
+	const uint32 frameDuration = (_videoTrack->getFrameRate().getInverse() * 1000).toInt();
+	return getTime() >= _videoTrack->getNextFrameStartTime() + frameDuration;
+}
+
+void TheoraDecoder::skipNextFrame() {
+	if (!_videoTrack)
+		return;
+
+	_videoTrack->setSkipConversion(true);
+	decodeNextFrame();
+	_videoTrack->setSkipConversion(false);
+}
+
 void TheoraDecoder::readNextPacket() {
 	// First, let's get our frame
 	if (_hasVideo) {
@@ -269,6 +290,7 @@ TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(const Graphics::PixelFormat &f
 	_frameRate = Common::Rational(theoraInfo.fps_numerator, theoraInfo.fps_denominator);
 
 	_endOfVideo = false;
+	_skipConversion = false;
 	_nextFrameStartTime = 0.0;
 	_curFrame = -1;
 }
@@ -285,9 +307,11 @@ bool TheoraDecoder::TheoraVideoTrack::decodePacket(ogg_packet &oggPacket) {
 		_curFrame++;
 
 		// Convert YUV data to RGB data
-		th_ycbcr_buffer yuv;
-		th_decode_ycbcr_out(_theoraDecode, yuv);
-		translateYUVtoRGBA(yuv);
+		if (!_skipConversion) {
+			th_ycbcr_buffer yuv;
+			th_decode_ycbcr_out(_theoraDecode, yuv);
+			translateYUVtoRGBA(yuv);
+		}
 
 		double time = th_granule_time(_theoraDecode, oggPacket.granulepos);
 
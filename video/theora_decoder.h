@@ -70,6 +70,25 @@ public:
 	bool loadStream(Common::SeekableReadStream *stream);
 	void close();
 
+	/**
+	 * Returns the time in ms at which the next frame is due.
+	 */
+	uint32 getNextFrameStartTime() const;
+
+	/**
+	 * Returns true if the frame after the next one is already due by the
+	 * playback clock, which follows the audio track when there is one.
+	 * The next frame can then be dropped with skipNextFrame().
+	 */
+	bool isNextFrameLate() const;
+
+	/**
+	 * Decode the next frame without converting it to RGB. The frame is
+	 * still fed to the Theora decoder, since later frames depend on it,
+	 * but the surface keeps the previously decoded picture.
+	 */
+	void skipNextFrame();
+
 protected:
 	void readNextPacket();
 
@@ -90,10 +109,12 @@ private:
 
 		bool decodePacket(ogg_packet &oggPacket);
 		void setEndOfVideo() { _endOfVideo = true; }
+		void setSkipConversion(bool skipConversion) { _skipConversion = skipConversion; }
 
 	private:
 		int _curFrame;
 		bool _endOfVideo;
+		bool _skipConversion;
 		Common::Rational _frameRate;
 		double _nextFrameStartTime;
 